@@ -11,6 +11,11 @@
  *   iDSK hello.dsk -n
  *   iDSK hello.dsk -i ./hello.cpc
  * Run: run"hello.cpc
+ *
+ * Without -clib=ansi and with -DTEXT_FIRMWARE (make CLIB=lean) the
+ * text goes straight through the firmware's TXT OUTPUT instead of
+ * z88dk's ANSI terminal.  With -DBENCH it times its own printing
+ * (make compare).
  */
 
 #include <stdio.h>
@@ -19,11 +24,57 @@
  * SCREEN HELPERS
  * ============================================================ */
 
+#ifdef TEXT_FIRMWARE
+/* Control code 12 clears the window and homes the cursor */
+void cls(void)
+{
+    putchar(12);
+}
+#else
 void cls(void)
 {
     putchar(27); putchar('['); putchar('2'); putchar('J');
     putchar(27); putchar('['); putchar('H');
 }
+#endif
+
+
+#ifdef BENCH
+/* ============================================================
+ * CHARACTER BENCHMARK
+ * ============================================================ */
+
+#define BENCH_LINES 50
+#define BENCH_CHARS (BENCH_LINES * 40)
+
+/* KL TIME PLEASE: the firmware's 300Hz clock, in DEHL */
+unsigned long kl_time(void) __naked
+{
+#asm
+    jp $BD0D
+#endasm
+}
+
+/* Print BENCH_CHARS characters, 39 and a newline a line, and
+ * report the cost of each in microseconds (3333 per tick) */
+void bench(void)
+{
+    unsigned long t0;
+    unsigned int ticks;
+    unsigned char i, j;
+
+    t0 = kl_time();
+    for (i = 0; i < BENCH_LINES; i++) {
+        for (j = 0; j < 39; j++)
+            putchar('A' + j % 26);
+        putchar('\n');
+    }
+    ticks = kl_time() - t0;
+    cls();
+    printf("%u chars in %u/300 s\n", BENCH_CHARS, ticks);
+    printf("%u us a character\n", ticks * 5 / 3);
+}
+#endif
 
 
 /* ============================================================
@@ -33,8 +84,12 @@ void cls(void)
 int main(void)
 {
     cls();
+#ifdef BENCH
+    bench();
+#else
     puts("");
     puts("Hello World");
+#endif
     puts("");
     puts("  Press any key...");
     fgetc_cons();
@@ -1,5 +1,5 @@
 /*
- * CPC ASCII MAZE - version 0.2
+ * CPC ASCII MAZE - version 0.3
  * Amstrad CPC 6128 / z88dk
  *
  * by @mathsDOTearth on github
@@ -8,12 +8,27 @@
  * v0.2 - Continuous play: completing a maze randomly picks
  *        another (1-255), awards +100 energy & score bonus.
  *        Game continues until energy runs out.
+ * v0.3 - Map and status drawn by a direct-to-screen text
+ *        engine instead of ANSI escape sequences.  The engine
+ *        is now the mazecore library shared with Sultan's Maze
+ *        II; this file is scoring, levels and the screens.
  * 
  * Compile:
- *   zcc +cpc -clib=ansi -lndos -O2 -create-app maze.c -o maze.bin
+ *   make -C ../mazecore         (builds mazecore4.lib)
+ *   zcc +cpc -clib=ansi -lndos -O2 -create-app -I../mazecore \
+ *       maze.c -L../mazecore -lmazecore4 -o maze.bin
+ *   (seedtab.h comes from ../tools/levelcheck - see the Makefile)
+ *   For mazes from a level pack build the library with
+ *   LEVELS=pack and put the level pack on the disc
+ *   (make LEVELS=pack here does all of that)
  *   iDSK maze.dsk -n
  *   iDSK maze.dsk -i ./maze.cpc
  * Run: run"maze.cpc
+ *
+ * The same source builds for a PC with gcc -DHOST against
+ * ../mazecore/screen_host.c: "make host" gives maze_host.
+ * Without -clib=ansi, and with the library built CLIB=lean, the
+ * text screens go through the firmware's text output instead.
  */
 
 #pragma output CRT_STACK_SIZE = 512
@@ -21,364 +36,73 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-
-extern int fgetc_cons(void);
-
-/* ============================================================
- * CONSTANTS
- * ============================================================ */
-
-#define MAZE_W    16
-#define MAZE_H    16
-#define NUM_GEMS   6
-
-#define DIR_N 0
-#define DIR_E 1
-#define DIR_S 2
-#define DIR_W 3
-
-#define CELL_WALL  1
-#define CELL_GEM   2
-#define CELL_EXIT  4
+#include "rng.h"
+#include "mazegen.h"
+#include "screen.h"
+#include "input.h"
+#include "play.h"
+#include "sound.h"
+#include "seedtab.h"
 
 /* ============================================================
  * GLOBAL STATE
  * ============================================================ */
 
-unsigned char maze[MAZE_H][MAZE_W];
-unsigned char px, py, pdir;
-int energy;
-unsigned char gems_collected;
-unsigned char gems_total;
-unsigned char ghost_x, ghost_y;
-unsigned char ghost_timer;
-unsigned char game_running;
-unsigned char maze_seed;
-
 /* Scoring and level tracking */
-int score;
+unsigned char score[BCD_LEN];
 unsigned char level;
-
-unsigned char gem_x[NUM_GEMS], gem_y[NUM_GEMS];
-unsigned char gem_taken[NUM_GEMS];
-unsigned char exit_x, exit_y;
-
-const signed char dx[] = { 0, 1, 0, -1 };
-const signed char dy[] = { -1, 0, 1, 0 };
-
-/* Previous positions for partial redraw */
-unsigned char old_px, old_py, old_gx, old_gy;
-
-/* ============================================================
- * SIMPLE RNG (LFSR)
- * ============================================================ */
-
-unsigned int rng_state;
-
-unsigned char rng(void)
-{
-    unsigned char bit;
-    bit = ((rng_state >> 0) ^ (rng_state >> 2) ^
-           (rng_state >> 3) ^ (rng_state >> 5)) & 1;
-    rng_state = (rng_state >> 1) | (bit << 15);
-    return (unsigned char)(rng_state & 0xFF);
-}
+unsigned char level_bcd[BCD_LEN];  /* level, for display */
 
 /* ============================================================
- * SCREEN HELPERS
+ * STATUS PANEL
+ * Labels are only drawn by draw_status(); during play just the
+ * changed digits are redrawn.
  * ============================================================ */
 
-void cls(void)
-{
-    putchar(27); putchar('['); putchar('2'); putchar('J');
-    putchar(27); putchar('['); putchar('H');
-}
-
-void goto_xy(unsigned char x, unsigned char y)
-{
-    putchar(27); putchar('[');
-    if (y >= 10) putchar('0' + y / 10);
-    putchar('0' + y % 10);
-    putchar(';');
-    if (x >= 10) putchar('0' + x / 10);
-    putchar('0' + x % 10);
-    putchar('H');
-}
+#define DF_SCORE   DF_GAME
+#define DF_LEVEL   (DF_GAME << 1)
 
-void print_at(unsigned char x, unsigned char y, char *s)
-{
-    goto_xy(x, y);
-    while (*s) { putchar(*s); s++; }
-}
+char score_shown[6];              /* digit glyphs now on screen */
+char level_shown[3];
+char energy_shown[4];
 
-void print_num_at(unsigned char x, unsigned char y, int n)
+void draw_fields(void)
 {
-    char buf[8];
-    int i = 0;
-    goto_xy(x, y);
-    if (n == 0) { putchar('0'); return; }
-    if (n < 0) { putchar('-'); n = -n; }
-    while (n > 0 && i < 7) { buf[i++] = '0' + (n % 10); n /= 10; }
-    while (i > 0) putchar(buf[--i]);
-}
-
-/* ============================================================
- * CONFIRM PROMPT - "Are you sure? Y/N"
- * Returns 1 if Y, 0 if N
- * ============================================================ */
-
-unsigned char confirm(unsigned char row)
-{
-    int key;
-    print_at(1, row, "Are you sure? (Y/N)    ");
-    while (1) {
-        key = fgetc_cons();
-        if (key == 'y' || key == 'Y') return 1;
-        if (key == 'n' || key == 'N') return 0;
-    }
-}
-
-/* ============================================================
- * MAZE GENERATION
- * ============================================================ */
-
-#define STACK_SIZE 128
-unsigned char stk_x[STACK_SIZE];
-unsigned char stk_y[STACK_SIZE];
-unsigned int stk_ptr;
-
-void generate_maze(void)
-{
-    unsigned char x, y, nx, ny;
-    unsigned char dirs[4];
-    unsigned char i, j, count;
-
-    for (y = 0; y < MAZE_H; y++)
-        for (x = 0; x < MAZE_W; x++)
-            maze[y][x] = CELL_WALL;
-
-    x = 1; y = 1; maze[y][x] = 0;
-    stk_ptr = 0;
-    stk_x[stk_ptr] = x; stk_y[stk_ptr] = y; stk_ptr++;
-
-    while (stk_ptr > 0) {
-        x = stk_x[stk_ptr - 1]; y = stk_y[stk_ptr - 1];
-        count = 0;
-        for (i = 0; i < 4; i++) {
-            nx = x + dx[i] * 2; ny = y + dy[i] * 2;
-            if (nx >= 1 && nx < MAZE_W - 1 &&
-                ny >= 1 && ny < MAZE_H - 1 &&
-                maze[ny][nx] == CELL_WALL)
-                dirs[count++] = i;
-        }
-        if (count == 0) { stk_ptr--; }
-        else {
-            j = rng() % count; i = dirs[j];
-            nx = x + dx[i] * 2; ny = y + dy[i] * 2;
-            maze[y + dy[i]][x + dx[i]] = 0;
-            maze[ny][nx] = 0;
-            stk_x[stk_ptr] = nx; stk_y[stk_ptr] = ny; stk_ptr++;
-        }
-    }
-
-    for (i = 0; i < 10; i++) {
-        x = (rng() % (MAZE_W - 4)) + 2;
-        y = (rng() % (MAZE_H - 4)) + 2;
-        if (maze[y][x] == CELL_WALL) {
-            count = 0;
-            if (y > 0 && maze[y-1][x] == 0) count++;
-            if (y < MAZE_H-1 && maze[y+1][x] == 0) count++;
-            if (x > 0 && maze[y][x-1] == 0) count++;
-            if (x < MAZE_W-1 && maze[y][x+1] == 0) count++;
-            if (count == 2) maze[y][x] = 0;
-        }
-    }
-}
-
-/* ============================================================
- * PLACE ITEMS (no longer resets energy - caller handles that)
- * ============================================================ */
-
-void place_items(void)
-{
-    unsigned char i, x, y;
-
-    px = 1; py = 1; pdir = DIR_E;
-    maze[1][1] = 0;
-
-    gems_total = NUM_GEMS;
-    for (i = 0; i < NUM_GEMS; i++) {
-        do {
-            x = (rng() % (MAZE_W - 2)) + 1;
-            y = (rng() % (MAZE_H - 2)) + 1;
-        } while (maze[y][x] != 0 || (x <= 2 && y <= 2));
-        gem_x[i] = x; gem_y[i] = y; gem_taken[i] = 0;
-        maze[y][x] |= CELL_GEM;
-    }
-
-    exit_x = MAZE_W - 2; exit_y = MAZE_H - 2;
-    maze[exit_y][exit_x] = CELL_EXIT;
-    if (maze[exit_y - 1][exit_x] == CELL_WALL &&
-        maze[exit_y][exit_x - 1] == CELL_WALL)
-        maze[exit_y - 1][exit_x] = 0;
-
-    do {
-        ghost_x = (rng() % (MAZE_W - 4)) + 2;
-        ghost_y = (rng() % (MAZE_H - 4)) + 2;
-    } while ((maze[ghost_y][ghost_x] & CELL_WALL) ||
-             (ghost_x + ghost_y < 8));
-
-    ghost_timer = 0;
-    gems_collected = 0;
-    game_running = 1;
-    old_px = px; old_py = py;
-    old_gx = ghost_x; old_gy = ghost_y;
-}
-
-/* ============================================================
- * HELPERS
- * ============================================================ */
-
-unsigned char is_wall(unsigned char cx, unsigned char cy)
-{
-    if (cx >= MAZE_W || cy >= MAZE_H) return 1;
-    return (maze[cy][cx] & CELL_WALL) ? 1 : 0;
-}
-
-unsigned char is_border(unsigned char cx, unsigned char cy)
-{
-    if (cx == 0 || cx == MAZE_W - 1) return 1;
-    if (cy == 0 || cy == MAZE_H - 1) return 1;
-    return 0;
-}
-
-/* ============================================================
- * GHOST AI
- * ============================================================ */
-
-void move_ghost(void)
-{
-    unsigned char best_dir, best_dist, i, nx, ny, dist;
-    unsigned char moved;
-
-    if ((rng() & 3) == 0) {
-        i = rng() & 3;
-        nx = ghost_x + dx[i]; ny = ghost_y + dy[i];
-        if (!is_wall(nx, ny)) {
-            ghost_x = nx; ghost_y = ny; return;
-        }
-    }
-
-    best_dir = 0; best_dist = 255; moved = 0;
-    for (i = 0; i < 4; i++) {
-        nx = ghost_x + dx[i]; ny = ghost_y + dy[i];
-        if (!is_wall(nx, ny)) {
-            dist = abs((int)nx - (int)px) + abs((int)ny - (int)py);
-            if (dist < best_dist) {
-                best_dist = dist; best_dir = i; moved = 1;
-            }
-        }
-    }
-    if (moved) {
-        ghost_x += dx[best_dir]; ghost_y += dy[best_dir];
-    }
-}
-
-/* ============================================================
- * DRAWING
- * ============================================================ */
-
-void draw_cell(unsigned char x, unsigned char y)
-{
-    char ch;
-    goto_xy(x + 1, y + 2);
-    if (x == px && y == py) {
-        switch (pdir) {
-            case DIR_N: ch = '^'; break;
-            case DIR_E: ch = '>'; break;
-            case DIR_S: ch = 'v'; break;
-            case DIR_W: ch = '<'; break;
-            default:    ch = '@'; break;
-        }
-    } else if (x == ghost_x && y == ghost_y) {
-        ch = 'G';
-    } else if (maze[y][x] & CELL_WALL) {
-        ch = '#';
-    } else if (maze[y][x] & CELL_GEM) {
-        ch = '*';
-    } else if (maze[y][x] & CELL_EXIT) {
-        ch = 'E';
-    } else {
-        ch = '.';
-    }
-    putchar(ch);
-}
-
-void draw_map(void)
-{
-    unsigned char x, y;
-    for (y = 0; y < MAZE_H; y++) {
-        goto_xy(1, y + 2);
-        for (x = 0; x < MAZE_W; x++) {
-            if (x == px && y == py) {
-                switch (pdir) {
-                    case DIR_N: putchar('^'); break;
-                    case DIR_E: putchar('>'); break;
-                    case DIR_S: putchar('v'); break;
-                    case DIR_W: putchar('<'); break;
-                    default:    putchar('@'); break;
-                }
-            } else if (x == ghost_x && y == ghost_y) {
-                putchar('G');
-            } else if (maze[y][x] & CELL_WALL) {
-                putchar('#');
-            } else if (maze[y][x] & CELL_GEM) {
-                putchar('*');
-            } else if (maze[y][x] & CELL_EXIT) {
-                putchar('E');
-            } else {
-                putchar('.');
-            }
-        }
-    }
-}
-
-void update_map(void)
-{
-    draw_cell(old_px, old_py);
-    draw_cell(old_gx, old_gy);
-    draw_cell(px, py);
-    draw_cell(ghost_x, ghost_y);
+    if (dirty_fields & DF_SCORE)
+        draw_bcd(7, 18, score, score_shown, 6);
+    if (dirty_fields & DF_LEVEL)
+        draw_bcd(21, 18, level_bcd, level_shown, 3);
+    if (dirty_fields & DF_ENERGY)
+        draw_bcd(8, 19, energy, energy_shown, 4);
+    if (dirty_fields & DF_GEMS)
+        put_glyph(22, 19, '0' + gems_collected);
 }
 
+/* Full status area - start of each level and after a scroll */
 void draw_status(void)
 {
     print_at(1, 19, "Score:");
-    print_num_at(8, 19, score);
-    putchar(' '); putchar(' '); putchar(' ');
-
     print_at(17, 19, "Lvl:");
-    print_num_at(22, 19, (int)level);
-    putchar(' '); putchar(' ');
-
     print_at(1, 20, "Energy:");
-    print_num_at(9, 20, energy);
-    putchar(' '); putchar(' '); putchar(' ');
-
     print_at(17, 20, "Gems:");
-    print_num_at(23, 20, (int)gems_collected);
-    putchar('/');
-    putchar('0' + gems_total);
-
-    print_at(1, 22, "WASD=move P=part Q=quit");
+    put_glyph(23, 19, '/');
+    put_glyph(24, 19, '0' + gems_total);
+    print_at(1, 22, "WASD=move P=part H=hint Q=quit");
+    memset(score_shown, 0, sizeof(score_shown));
+    memset(level_shown, 0, sizeof(level_shown));
+    memset(energy_shown, 0, sizeof(energy_shown));
+    dirty_fields = DF_ALL;
+    flush_dirty();
 }
 
 /* ============================================================
  * LEVEL COMPLETE SCREEN (brief, shown between mazes)
  * ============================================================ */
 
-void level_complete_screen(int bonus)
+void level_complete_screen(unsigned char *bonus)
 {
+    char buf[BCD_LEN * 2 + 1];
+
     cls();
     puts("");
     puts("  **************************");
@@ -388,17 +112,17 @@ void level_complete_screen(int bonus)
     printf("  Maze #%d cleared!\n", maze_seed);
     puts("");
     printf("  Base score:    +100\n");
-    printf("  Energy bonus:  +%d\n", bonus);
+    printf("  Energy bonus:  +%s\n", bcd_str(buf, bonus));
     printf("  Energy refill: +100\n");
     puts("");
-    printf("  Total score: %d\n", score);
-    printf("  Energy: %d\n", energy);
+    printf("  Total score: %s\n", bcd_str(buf, score));
+    printf("  Energy: %s\n", bcd_str(buf, energy));
     puts("");
     printf("  Level %d complete!\n", level);
     puts("");
     puts("  Next maze loading...");
     puts("  Press any key!");
-    fgetc_cons();
+    key_get();
 }
 
 /* ============================================================
@@ -408,13 +132,10 @@ void level_complete_screen(int bonus)
 
 unsigned char title_screen(void)
 {
-    int key;
-    unsigned char seed;
-
     cls();
     puts("");
     puts("    ========================");
-    puts("     CPC ASCII  MAZE  v0.2");
+    puts("     CPC ASCII  MAZE  v0.3");
     puts("    ========================");
     puts("");
     puts("  Collect the jewels");
@@ -429,43 +150,15 @@ unsigned char title_screen(void)
     puts("");
     puts("  W-Fwd S-Back A/D-Turn");
     puts("  P-Part hedge (-50 energy)");
-    puts("  Q-Quit");
+    puts("  H-Hint Q-Quit");
     puts("");
-    puts("  Start maze (1-255)/ENTER:");
-
-    seed = 0;
-    while (1) {
-        key = fgetc_cons();
-        if (key == 13 || key == 10) break;
-        if (key == 'q' || key == 'Q') {
-            if (confirm(23)) return 1;
-            print_at(1, 23, "  Start maze (1-255)/ENTER:");
-            continue;
-        }
-        if (key >= '0' && key <= '9') {
-            putchar(key);
-            seed = seed * 10 + (key - '0');
-        }
-    }
-
-    if (seed == 0) {
-        rng_state = 7777;
-        maze_seed = 0;
-        puts("");
-        puts("  Random maze!");
-    } else {
-        rng_state = (unsigned int)seed * 257 + 1;
-        maze_seed = seed;
-    }
+    if (ask_maze(23, "  Start maze (1-255)/ENTER:")) return 1;
 
     /* Initialise session state */
-    score = 0;
+    bcd_set(score, 0);
     level = 1;
-    energy = 500;
-
-    puts("");
-    puts("  Press any key...");
-    fgetc_cons();
+    bcd_set(level_bcd, 0x01);
+    bcd_set(energy, 0x0500);
     return 0;
 }
 
@@ -475,6 +168,8 @@ unsigned char title_screen(void)
 
 void gameover_screen(void)
 {
+    char buf[BCD_LEN * 2 + 1];
+
     cls();
     puts("");
     puts("  **************************");
@@ -482,182 +177,136 @@ void gameover_screen(void)
     puts("  **************************");
     puts("");
     puts("  Your energy ran out!");
-    printf("  Final score: %d\n", score);
+    printf("  Final score: %s\n", bcd_str(buf, score));
     printf("  Mazes cleared: %d\n", level - 1);
     printf("  Gems this maze: %d / %d\n", gems_collected, gems_total);
     if (maze_seed > 0)
         printf("  Last maze: #%d\n", maze_seed);
     puts("");
     puts("  Press any key...");
-    fgetc_cons();
+    key_get();
+}
+
+/* ============================================================
+ * GHOSTS PER LEVEL - one more every 4 levels, up to MAX_GHOSTS
+ * ============================================================ */
+
+void set_ghost_count(void)
+{
+    num_ghosts = 1 + (level >> 2);
+    if (num_ghosts > MAX_GHOSTS) num_ghosts = MAX_GHOSTS;
 }
 
 /* ============================================================
  * START NEXT LEVEL
- * Picks a random maze seed 1-255, generates & places items.
+ * Picks a random maze seed, generates & places items.  Seeds
+ * come from seedtab.h, the mazes tools/levelcheck found can be
+ * finished on the energy available, cheapest first; the pick
+ * window slides up the table as the levels go by.
  * Energy carries over (caller already added the +100 bonus).
+ *
+ * In real time the next maze is picked as this one starts, so it
+ * can be carved in the background while this one is played.
  * ============================================================ */
 
-void start_next_level(void)
+#if SEED_COUNT > 64
+#define SEED_WINDOW 64
+#else
+#define SEED_WINDOW SEED_COUNT
+#endif
+
+/* From the play stream, so the maze itself depends only on its
+ * number */
+unsigned char pick_seed(unsigned char lvl)
 {
-    unsigned char new_seed;
+#if SEED_COUNT
+    unsigned int i;
+    i = (unsigned int)lvl << 2;
+    if (i > SEED_COUNT - SEED_WINDOW) i = SEED_COUNT - SEED_WINDOW;
+    return seed_by_cost[i + rng_play_below(SEED_WINDOW)];
+#else
+    return rng_play_below(255) + 1;
+#endif
+}
 
-    /* Pick a random maze 1-255 */
-    do {
-        new_seed = rng();
-    } while (new_seed == 0);
+#ifdef MAZE_AHEAD
+unsigned char ahead_seed;       /* the maze after this one */
 
-    maze_seed = new_seed;
-    rng_state = (unsigned int)new_seed * 257 + 1;
+void plan_next_level(void)
+{
+    ahead_seed = pick_seed(level + 1);
+    maze_ahead(ahead_seed);
+}
+#endif
 
-    generate_maze();
+void start_next_level(void)
+{
+#ifdef MAZE_AHEAD
+    maze_seed = ahead_seed;
+#else
+    maze_seed = pick_seed(level);
+#endif
+    rng_layout_seed(maze_seed);
+
+    set_ghost_count();
+    new_maze();
     place_items();
 }
 
 /* ============================================================
  * MAIN GAME LOOP
+ * Each escape scores, shows the level screen and goes straight
+ * on to the next maze.
  * Returns: 0 = back to title, 1 = quit program
  * ============================================================ */
 
 unsigned char game_loop(void)
 {
-    int key;
-    unsigned char nx, ny;
     unsigned char i;
-    int bonus;
-
-    cls();
-    draw_map();
-    draw_status();
-
-    while (game_running) {
-        key = fgetc_cons();
-
-        /* Save old positions for partial redraw */
-        old_px = px; old_py = py;
-        old_gx = ghost_x; old_gy = ghost_y;
-
-        switch (key) {
-            case 'w': case 'W':
-                nx = px + dx[pdir]; ny = py + dy[pdir];
-                if (!is_wall(nx, ny)) {
-                    px = nx; py = ny;
-                    energy -= 2;
-                    ghost_timer++;
-                }
-                break;
-
-            case 's': case 'S':
-                nx = px - dx[pdir]; ny = py - dy[pdir];
-                if (!is_wall(nx, ny)) {
-                    px = nx; py = ny;
-                    energy -= 2;
-                    ghost_timer++;
-                }
-                break;
-
-            case 'a': case 'A':
-                pdir = (pdir + 3) & 3;
-                energy -= 1;
-                break;
+    unsigned char bonus[BCD_LEN];
 
-            case 'd': case 'D':
-                pdir = (pdir + 1) & 3;
-                energy -= 1;
-                break;
-
-            case 'p': case 'P':
-                nx = px + dx[pdir];
-                ny = py + dy[pdir];
-                if (is_wall(nx, ny) && !is_border(nx, ny) && energy > 50) {
-                    maze[ny][nx] = 0;
-                    px = nx; py = ny;
-                    energy -= 50;
-                    ghost_timer++;
-                    draw_cell(nx, ny);
-                    print_at(1, 23, "* Hedge parted! -50 *  ");
-                } else if (is_border(nx, ny)) {
-                    print_at(1, 23, "Can't part the border! ");
-                } else if (energy <= 50) {
-                    print_at(1, 23, "Not enough energy!     ");
-                } else {
-                    print_at(1, 23, "No hedge ahead!        ");
-                }
+#ifdef MAZE_AHEAD
+    plan_next_level();
+#endif
+    snd_music(&tune_maze);
+    play_start();
+    while (1) {
+        switch (play_maze()) {
+            case PLAY_ESCAPED:
+                snd_sfx(SFX_LEVEL);
                 break;
-
-            case 'q': case 'Q':
-                if (confirm(23)) {
-                    game_running = 0;
-                    return 0;  /* back to title */
-                }
-                /* They said No - clear prompt and continue */
-                print_at(1, 23, "                       ");
-                continue;
-
+            case PLAY_DEAD:
+                snd_music(0);
+                gameover_screen();
+                return 0;  /* back to title */
             default:
-                continue;
-        }
-
-        /* Check gem pickup */
-        for (i = 0; i < NUM_GEMS; i++) {
-            if (!gem_taken[i] && px == gem_x[i] && py == gem_y[i]) {
-                gem_taken[i] = 1;
-                gems_collected++;
-                maze[gem_y[i]][gem_x[i]] &= ~CELL_GEM;
-                print_at(1, 23, "** GEM FOUND! **       ");
-            }
-        }
-
-        /* Check exit - level complete! */
-        if (px == exit_x && py == exit_y) {
-            if (gems_collected >= gems_total) {
-                /* Award score: 100 base + energy bonus */
-                bonus = energy / 5;
-                score += 100 + bonus;
-                energy += 100;
-
-                level_complete_screen(bonus);
-
-                /* Advance to next random maze */
-                level++;
-                start_next_level();
-
-                /* Redraw for new level */
-                cls();
-                draw_map();
-                draw_status();
-                continue;
-            } else {
-                print_at(1, 23, "Find all gems first!   ");
-            }
+                snd_music(0);
+                return 0;
         }
 
-        /* Move ghost every 3 player moves */
-        if (ghost_timer >= 3) {
-            move_ghost();
-            ghost_timer = 0;
-        }
-
-        /* Ghost collision */
-        if (px == ghost_x && py == ghost_y) {
-            energy -= 50;
-            print_at(1, 23, "!! GHOST !! -50 energy ");
-            nx = px - dx[pdir]; ny = py - dy[pdir];
-            if (!is_wall(nx, ny)) { px = nx; py = ny; }
-        }
-
-        /* Check energy */
-        if (energy <= 0) {
-            gameover_screen();
-            return 0;  /* back to title */
-        }
-
-        /* Partial map redraw */
-        update_map();
-        draw_status();
+        /* Award score: 100 base + energy bonus.
+         * energy / 5 = (energy * 2) shifted one digit */
+        bcd_set(bonus, 0);
+        bcd_add(bonus, energy);
+        bcd_add(bonus, energy);
+        for (i = 0; i < BCD_LEN - 1; i++)
+            bonus[i] = (bonus[i] >> 4) | (bonus[i + 1] << 4);
+        bonus[BCD_LEN - 1] >>= 4;
+        bcd_add_k(score, 0x0100);
+        bcd_add(score, bonus);
+        bcd_add_k(energy, 0x0100);
+
+        level_complete_screen(bonus);
+
+        /* Advance to next random maze */
+        level++;
+        bcd_add_k(level_bcd, 0x01);
+        start_next_level();
+#ifdef MAZE_AHEAD
+        plan_next_level();
+#endif
+        play_start();
     }
-
-    return 0;
 }
 
 /* ============================================================
@@ -666,9 +315,13 @@ unsigned char game_loop(void)
 
 int main(void)
 {
+    char buf[BCD_LEN * 2 + 1];
+
+    key_init();
     while (1) {
         if (title_screen()) break;  /* Q at title = exit */
-        generate_maze();
+        set_ghost_count();
+        new_maze();
         place_items();
         if (game_loop()) break;
     }
@@ -676,7 +329,9 @@ int main(void)
     cls();
     puts("");
     puts("  Thanks for playing!");
-    printf("  Final score: %d\n", score);
+    printf("  Final score: %s\n", bcd_str(buf, score));
     puts("");
+    snd_done();
+    key_done();
     return 0;
 }
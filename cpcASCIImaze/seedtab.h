@@ -0,0 +1,41 @@
+/* seedtab.h - written by tools/levelcheck, do not edit.
+ * The 255 maze numbers that can be finished without parting
+ * a hedge for at most 400 energy, cheapest first (95-289).
+ * 0 left out: 0 need a hedge parted, 0 cost too much. */
+
+#if MAZE_SHIFT != 4
+#error seedtab.h is for another maze size - rebuild it
+#endif
+#ifdef MAZE_GEN_ELLER
+#error seedtab.h is for another maze carver - rebuild it
+#endif
+#ifdef RNG_FAST_LAYOUT
+#error seedtab.h is for another layout RNG - rebuild it
+#endif
+
+#define SEED_COUNT 255
+
+const unsigned char seed_by_cost[SEED_COUNT] = {
+   171, 150, 213, 128, 145, 181,  17, 178, 247, 175, 210, 234,
+   242,  57, 246, 238, 185, 223, 225, 179, 182,   9,  98, 161,
+    49,  66, 120,  18, 110, 112,  62, 127, 193,  73,  92,  72,
+   131, 155, 240,  20,  23,  47, 217,   1,  25,  34,  89,  93,
+   113, 115, 134, 154, 230,  55, 114, 122, 139, 146,   4,  38,
+    44, 105, 160, 206, 220, 221,  56,  21,  64,  65, 116, 152,
+   233, 100, 107, 118, 137, 227,  28,  43, 101, 104, 151,  75,
+   177, 255,  45, 121, 164, 190, 232,  39,  71,  99, 167, 173,
+    30,  52,  63,  88, 119, 174, 253,   5,  50,  74, 153, 168,
+   169, 170, 209,  10,  41,  94,  97, 130,   3,   8,  14, 156,
+   196,  15,  67, 140, 244,  33,  54,  85,  96, 109, 133, 243,
+   252, 106, 108, 194, 197, 231,  27, 126, 135, 207, 216, 239,
+    40,  86, 188,   6,   7, 176, 201,  19, 138, 147, 157, 172,
+   229, 248,  32, 184, 212, 215,  29,  48, 124, 129, 191, 218,
+   148, 192, 203, 237, 245, 249,  13,  26,  76,  79,  81,  91,
+   159, 202,  22, 226,  12,  24,  69,  83, 123, 144, 183, 198,
+   199, 236,   2,  37, 142,  35,  58,  61,  90,  95, 143,  46,
+   158, 111, 208, 222, 241,  70,  77,  78,  84, 186, 204,  16,
+   149,  51,  80, 187, 224,  31, 117, 254, 228, 251, 102, 200,
+    87, 103, 141, 195,  60, 165, 214,  11, 180,  42,  59,  53,
+   205,  36,  68,  82, 235, 136, 162, 219, 163, 250, 166, 211,
+   132, 189, 125,
+};
@@ -0,0 +1,110 @@
+/*
+ * bcd.c - packed BCD counters for the maze games
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ */
+
+#include <string.h>
+#include "bcd.h"
+
+/* ============================================================
+ * BCD COUNTERS
+ * Energy, score and level are packed BCD, least significant
+ * byte first, so they can be shown digit by digit without the
+ * Z80's slow software divide.  Constants are written as BCD in
+ * hex: 0x0050 means fifty.
+ * ============================================================ */
+
+/* n = k */
+void bcd_set(unsigned char *n, unsigned int k)
+{
+    n[0] = (unsigned char)k;
+    n[1] = (unsigned char)(k >> 8);
+    n[2] = 0;
+}
+
+/* n += v.  Saturates at 999999. */
+void bcd_add(unsigned char *n, unsigned char *v)
+{
+    unsigned char i, lo, hi, c;
+    c = 0;
+    for (i = 0; i < BCD_LEN; i++) {
+        lo = (n[i] & 0x0F) + (v[i] & 0x0F) + c;
+        c = 0;
+        if (lo > 9) { lo -= 10; c = 1; }
+        hi = (n[i] >> 4) + (v[i] >> 4) + c;
+        c = 0;
+        if (hi > 9) { hi -= 10; c = 1; }
+        n[i] = (hi << 4) | lo;
+    }
+    if (c) memset(n, 0x99, BCD_LEN);
+}
+
+/* n -= v.  Returns 1 and leaves n at zero if v > n. */
+unsigned char bcd_sub(unsigned char *n, unsigned char *v)
+{
+    unsigned char i, lo, hi, b;
+    b = 0;
+    for (i = 0; i < BCD_LEN; i++) {
+        lo = (n[i] & 0x0F) - (v[i] & 0x0F) - b;
+        b = 0;
+        if (lo > 9) { lo += 10; b = 1; }
+        hi = (n[i] >> 4) - (v[i] >> 4) - b;
+        b = 0;
+        if (hi > 9) { hi += 10; b = 1; }
+        n[i] = (hi << 4) | lo;
+    }
+    if (b) memset(n, 0, BCD_LEN);
+    return b;
+}
+
+void bcd_add_k(unsigned char *n, unsigned int k)
+{
+    unsigned char v[BCD_LEN];
+    bcd_set(v, k);
+    bcd_add(n, v);
+}
+
+unsigned char bcd_sub_k(unsigned char *n, unsigned int k)
+{
+    unsigned char v[BCD_LEN];
+    bcd_set(v, k);
+    return bcd_sub(n, v);
+}
+
+/* Packed BCD orders like binary, so compare from the top byte */
+signed char bcd_cmp_k(unsigned char *n, unsigned int k)
+{
+    unsigned char v[BCD_LEN];
+    unsigned char i;
+    bcd_set(v, k);
+    i = BCD_LEN;
+    while (i--) {
+        if (n[i] > v[i]) return 1;
+        if (n[i] < v[i]) return -1;
+    }
+    return 0;
+}
+
+unsigned char bcd_is_zero(unsigned char *n)
+{
+    return (n[0] | n[1] | n[2]) == 0;
+}
+
+/* Format n without leading zeros; buf needs BCD_LEN * 2 + 1 */
+char *bcd_str(char *buf, unsigned char *n)
+{
+    unsigned char k, d;
+    char *p = buf;
+    k = BCD_LEN * 2;
+    while (k--) {
+        d = n[k >> 1];
+        if (k & 1) d >>= 4;
+        d &= 0x0F;
+        if (d || p != buf || k == 0) *p++ = '0' + d;
+    }
+    *p = 0;
+    return buf;
+}
@@ -0,0 +1,29 @@
+/*
+ * bcd.h - packed BCD counters for the maze games
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * Energy, score and level are BCD_LEN bytes of packed BCD, least
+ * significant byte first.  Constants are written as BCD in hex:
+ * 0x0050 means fifty.
+ */
+
+#ifndef BCD_H
+#define BCD_H
+
+#define BCD_LEN    3    /* 6 digits */
+
+void bcd_set(unsigned char *n, unsigned int k);
+void bcd_add(unsigned char *n, unsigned char *v);
+unsigned char bcd_sub(unsigned char *n, unsigned char *v);
+void bcd_add_k(unsigned char *n, unsigned int k);
+unsigned char bcd_sub_k(unsigned char *n, unsigned int k);
+signed char bcd_cmp_k(unsigned char *n, unsigned int k);
+unsigned char bcd_is_zero(unsigned char *n);
+
+/* Without leading zeros; buf needs BCD_LEN * 2 + 1 */
+char *bcd_str(char *buf, unsigned char *n);
+
+#endif
@@ -0,0 +1,185 @@
+/*
+ * disc.c - reading and writing files through the firmware
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * See disc.h.  The CPC side is the CAS IN / CAS OUT entries; the
+ * host build does the same with stdio.
+ */
+
+#include "disc.h"
+
+#ifdef HOST
+
+#include <stdio.h>
+#include <ctype.h>
+
+static FILE *in_fp, *out_fp;
+
+static FILE *host_open(char *name, char *mode)
+{
+    char lower[16];
+    unsigned char i;
+
+    for (i = 0; name[i] && i < sizeof(lower) - 1; i++)
+        lower[i] = tolower((unsigned char)name[i]);
+    lower[i] = 0;
+    return fopen(lower, mode);
+}
+
+unsigned char cas_in_open(char *name)
+{
+    in_fp = host_open(name, "rb");
+    return in_fp != NULL;
+}
+
+int cas_in_char(void)
+{
+    return getc(in_fp);
+}
+
+void cas_in_close(void)
+{
+    fclose(in_fp);
+}
+
+unsigned char cas_out_open(char *name)
+{
+    out_fp = host_open(name, "wb");
+    return out_fp != NULL;
+}
+
+unsigned char cas_out_direct(unsigned char *buf, unsigned int len)
+{
+    return fwrite(buf, 1, len, out_fp) == len;
+}
+
+void cas_out_close(void)
+{
+    fclose(out_fp);
+}
+
+#else
+
+unsigned char cas_buf[2048];        /* AMSDOS sector buffer */
+
+/* ============================================================
+ * FIRMWARE
+ * The OPEN calls want the name length in B, the name in HL and
+ * a 2K buffer in DE.  Every call corrupts IX, which is saved.
+ * ============================================================ */
+
+unsigned char cas_in_open(char *name) __z88dk_fastcall __naked
+{
+#asm
+    push ix
+    ld   d, h
+    ld   e, l
+    ld   b, 0
+.cio_len
+    ld   a, (de)
+    or   a
+    jr   z, cio_open
+    inc  de
+    inc  b
+    jr   cio_len
+.cio_open
+    ld   de, _cas_buf
+    call $BC77              ; CAS IN OPEN
+    pop  ix
+    ld   hl, 0
+    ret  nc
+    inc  l
+    ret
+#endasm
+}
+
+int cas_in_char(void) __naked
+{
+#asm
+    push ix
+    call $BC80              ; CAS IN CHAR
+    pop  ix
+    ld   h, 0
+    ld   l, a
+    ret  c
+    ld   hl, -1
+    ret
+#endasm
+}
+
+void cas_in_close(void) __naked
+{
+#asm
+    push ix
+    call $BC7A              ; CAS IN CLOSE
+    pop  ix
+    ret
+#endasm
+}
+
+unsigned char cas_out_open(char *name) __z88dk_fastcall __naked
+{
+#asm
+    push ix
+    ld   d, h
+    ld   e, l
+    ld   b, 0
+.coo_len
+    ld   a, (de)
+    or   a
+    jr   z, coo_open
+    inc  de
+    inc  b
+    jr   coo_len
+.coo_open
+    ld   de, _cas_buf
+    call $BC8C              ; CAS OUT OPEN
+    pop  ix
+    ld   hl, 0
+    ret  nc
+    inc  l
+    ret
+#endasm
+}
+
+/* sccz80 pushes arguments left to right: len is at SP+2 and
+ * buf at SP+4 */
+unsigned char cas_out_direct(unsigned char *buf, unsigned int len) __naked
+{
+#asm
+    ld   hl, 2
+    add  hl, sp
+    ld   e, (hl)
+    inc  hl
+    ld   d, (hl)            ; DE = len
+    inc  hl
+    ld   a, (hl)
+    inc  hl
+    ld   h, (hl)
+    ld   l, a               ; HL = buf
+    push ix
+    ld   bc, 0              ; entry address
+    ld   a, 2               ; binary
+    call $BC98              ; CAS OUT DIRECT
+    pop  ix
+    ld   hl, 0
+    ret  nc
+    inc  l
+    ret
+#endasm
+}
+
+void cas_out_close(void) __naked
+{
+#asm
+    push ix
+    call $BC8F              ; CAS OUT CLOSE
+    pop  ix
+    ret
+#endasm
+}
+
+#endif
@@ -0,0 +1,38 @@
+/*
+ * disc.h - reading and writing files through the firmware
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * The cassette entries in the firmware jumpblock, which AMSDOS
+ * redirects to the disc.  Input and output share one 2K buffer,
+ * so only one file may be open at a time.  A file to read must
+ * have an AMSDOS header (iDSK -t 1): headerless files are read as
+ * text and stop at the first 0x1A.
+ *
+ * The host build (-DHOST) uses stdio on the same names in lower
+ * case, in the current directory.
+ */
+
+#ifndef DISC_H
+#define DISC_H
+
+#ifdef HOST
+#define __z88dk_fastcall
+#endif
+
+/* 1 if the file was opened */
+unsigned char cas_in_open(char *name) __z88dk_fastcall;
+/* Next byte of the file, or -1 at the end or on an error */
+int cas_in_char(void);
+void cas_in_close(void);
+
+/* Output is written in one go from memory, as a binary file with
+ * a header, so it can be read back byte by byte.  Each returns 1
+ * if it worked. */
+unsigned char cas_out_open(char *name) __z88dk_fastcall;
+unsigned char cas_out_direct(unsigned char *buf, unsigned int len);
+void cas_out_close(void);
+
+#endif
@@ -0,0 +1,163 @@
+/*
+ * input.c - keys for the maze games, with recording and replay
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * See input.h.  Keys are read from the platform with key_read()
+ * (screen.h); the log is read and written through disc.c.
+ */
+
+#include "screen.h"
+#include "disc.h"
+#include "input.h"
+#include "task.h"
+
+#if defined(KEY_REPLAY) || defined(KEY_SCRIPT)
+#define KEY_PLAYBACK
+#endif
+
+#if defined(KEY_RECORD) || defined(KEY_REPLAY)
+static unsigned char key_log[KEY_LOG_MAX];
+#endif
+
+#ifdef KEY_PLAYBACK
+/* Runs still to play back */
+static const unsigned char *log_at, *log_end;
+static unsigned char run_left, run_key;
+#endif
+
+#ifdef KEY_RECORD
+static unsigned int log_len;
+#endif
+#ifdef KEY_SCRIPT
+static unsigned char quit_next;
+#endif
+
+#ifdef KEY_PLAYBACK
+/* Play back the runs in p if the header matches this build */
+static void log_start(const unsigned char *p, unsigned int len)
+{
+    if (len < 4 || p[0] != 'K' || p[1] != 'L' ||
+        p[2] != MAZE_SHIFT || p[3] != KEY_LOG_GEN)
+        return;
+    log_at = p + 4;
+    log_end = p + (len & ~1u);
+}
+#endif
+
+void key_init(void)
+{
+#ifdef KEY_REPLAY
+    unsigned int len;
+    int c;
+#endif
+
+    fly_init();
+#ifdef KEY_REPLAY
+    if (cas_in_open(KEY_LOG_FILE)) {
+        len = 0;
+        while (len < KEY_LOG_MAX && (c = cas_in_char()) >= 0)
+            key_log[len++] = c;
+        cas_in_close();
+        log_start(key_log, len);
+    }
+#endif
+#ifdef KEY_SCRIPT
+    log_start(key_script, key_script_len);
+#endif
+#ifdef KEY_RECORD
+    key_log[0] = 'K';
+    key_log[1] = 'L';
+    key_log[2] = MAZE_SHIFT;
+    key_log[3] = KEY_LOG_GEN;
+    log_len = 4;
+#endif
+}
+
+void key_done(void)
+{
+#ifdef KEY_RECORD
+    if (cas_out_open(KEY_LOG_FILE)) {
+        cas_out_direct(key_log, log_len);
+        cas_out_close();
+    }
+#endif
+    fly_done();
+}
+
+#ifdef KEY_RECORD
+/* Add to the last run if it's the same key; once the log is
+ * full the rest of the session isn't kept */
+static void log_key(unsigned char key)
+{
+    if (log_len > 4 && key_log[log_len - 1] == key &&
+        key_log[log_len - 2] != 255) {
+        key_log[log_len - 2]++;
+        return;
+    }
+    if (log_len > KEY_LOG_MAX - 2) return;
+    key_log[log_len++] = 1;
+    key_log[log_len++] = key;
+}
+#endif
+
+#ifdef KEY_PLAYBACK
+/* The next key played back, or -1 once they have all gone */
+static int log_next(void)
+{
+    if (run_left) {
+        run_left--;
+        return run_key;
+    }
+    if (log_at != log_end) {
+        run_left = *log_at++ - 1;
+        run_key = *log_at++;
+        return run_key;
+    }
+    return -1;
+}
+#endif
+
+int key_get(void)
+{
+    int key;
+
+#ifdef KEY_PLAYBACK
+    key = log_next();
+    if (key >= 0) return key;
+#endif
+#ifdef KEY_SCRIPT
+    quit_next ^= 1;
+    key = quit_next ? 'q' : 'y';
+#else
+    key = key_read();
+#ifdef KEY_RECORD
+    log_key(key);
+#endif
+#endif
+    return key;
+}
+
+#ifdef REAL_TIME
+int key_tick(void)
+{
+    int key;
+
+    tick_wait();
+#ifdef KEY_PLAYBACK
+    key = log_next();
+    if (key >= 0) return key;
+#endif
+#ifdef KEY_SCRIPT
+    key = key_get();
+#else
+    key = key_scan();
+#ifdef KEY_RECORD
+    log_key(key);
+#endif
+#endif
+    return key;
+}
+#endif
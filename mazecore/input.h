@@ -0,0 +1,82 @@
+/*
+ * input.h - keys for the maze games, with recording and replay
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * Every key the games read goes through key_get().  Nothing else
+ * decides how a game goes - both random streams are seeded from
+ * the maze number typed at the title - so a log of the keys
+ * replays a session exactly, in a build with the same maze
+ * options.  Chosen when the library is built (see options.mk):
+ *
+ *   INPUT=record  keys are logged in RAM and saved to KEYS.REC
+ *                 when the game quits
+ *   INPUT=replay  KEYS.REC is played back, then the keyboard
+ *                 takes over
+ *   INPUT=script  the keys are key_script[], compiled into the
+ *                 game from a key file by tools/keyscript.  When
+ *                 it runs out the game is told Q and Y until it
+ *                 quits, so a session can run unattended (under
+ *                 z88dk-ticks, say)
+ *
+ * Log layout:
+ *   'K' 'L' MAZE_SHIFT KEY_LOG_GEN
+ *   runs of one key, two bytes each: count (1-255), key
+ *
+ * With REAL_TIME the game runs on a clock, and play reads what
+ * was pressed each tick with key_tick(), 0 for nothing.  Those
+ * zeros go in the log too, so a session still replays exactly:
+ * a run of 255 idle ticks is two bytes.
+ */
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#define KEY_LOG_FILE  "KEYS.REC"
+#define KEY_LOG_MAX   2048      /* bytes; a full log keeps the start */
+
+/* The options besides MAZE_SHIFT that change the mazes */
+#ifdef MAZE_GEN_ELLER
+#define KEY_LOG_ELLER 1
+#else
+#define KEY_LOG_ELLER 0
+#endif
+#ifdef RNG_FAST_LAYOUT
+#define KEY_LOG_FAST  2
+#else
+#define KEY_LOG_FAST  0
+#endif
+#ifdef REAL_TIME
+#define KEY_LOG_REAL  4
+#else
+#define KEY_LOG_REAL  0
+#endif
+#define KEY_LOG_GEN   (KEY_LOG_ELLER | KEY_LOG_FAST | KEY_LOG_REAL)
+
+#ifdef KEY_SCRIPT
+extern const unsigned char key_script[];
+extern const unsigned int key_script_len;
+#endif
+
+/* Load the log or script before the first key; save the log when
+ * the game is over */
+void key_init(void);
+void key_done(void);
+
+/* Wait for a key and return it */
+int key_get(void);
+
+#ifdef REAL_TIME
+#define TICK_FRAMES  8      /* frames (1/50 s) in a game tick */
+
+/* Wait for the next tick and return the key pressed since the last
+ * one, or 0.  A script plays out as fast as it can, without
+ * waiting.  A game too slow for a tick starts the next one at
+ * once, rather than catching up in a burst.  The wait goes on
+ * tasks (task.h). */
+int key_tick(void);
+#endif
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ * levelpak.c - precomputed mazes read from a pack file on disc
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * The file with maze n is read a byte at a time through the
+ * firmware's CAS IN entries (disc.c), which AMSDOS redirects to
+ * the disc, and decoded straight into the wall map.  See
+ * levelpak.h for the file layout.
+ */
+
+#include <string.h>
+#include "rng.h"
+#include "mazegen.h"
+#include "levelpak.h"
+#include "disc.h"
+
+static unsigned char pack_missing;  /* gave up on the disc */
+static unsigned char pack_bad;      /* read past end or error */
+static char pack_name[] = PACK_FILE;
+static const char pack_hex[] = "0123456789ABCDEF";
+
+/* ============================================================
+ * DECODER
+ * ============================================================ */
+
+static unsigned char pack_byte(void)
+{
+    int c;
+
+    c = cas_in_char();
+    if (c < 0) { pack_bad = 1; return 0; }
+    return c;
+}
+
+static cell_t pack_cell(void)
+{
+    cell_t c;
+
+    c = pack_byte();
+#if PACK_CELL == 2
+    c |= (cell_t)pack_byte() << 8;
+#endif
+    return c;
+}
+
+static unsigned char pack_read(unsigned char n)
+{
+    unsigned char i, x, y, first, count, bits, mask;
+    unsigned int at, skip;
+    cell_t c;
+
+    /* A pack for another maze size won't get better next level */
+    if (pack_byte() != 'M' || pack_byte() != 'Z' ||
+        pack_byte() != MAZE_SHIFT) {
+        pack_missing = 1;
+        return 0;
+    }
+    first = pack_byte();
+    count = pack_byte();
+    if (pack_bad || n < first || n - first >= count) return 0;
+
+    /* Keep maze n's index entry, read past the rest */
+    n -= first;
+    at = 0;
+    for (i = 0; i < count; i++) {
+        skip = pack_byte();
+        skip |= (unsigned int)pack_byte() << 8;
+        if (i == n) at = skip;
+    }
+    for (; at; at--) pack_byte();
+
+    rng_layout_state = pack_byte();
+    rng_layout_state |= (unsigned int)pack_byte() << 8;
+    c = pack_cell();
+    exit_x = c & (MAZE_W - 1); exit_y = c >> MAZE_SHIFT;
+    for (i = 0; i < NUM_GEMS; i++) {
+        c = pack_cell();
+        gem_x[i] = c & (MAZE_W - 1); gem_y[i] = c >> MAZE_SHIFT;
+        gem_taken[i] = 0;
+    }
+    gems_total = NUM_GEMS;
+
+    /* The lattice, with a bit from the pack for each slot */
+    memset(wall, 0xFF, sizeof(wall));
+    bits = 0; mask = 0;
+    for (y = 1; y < MAZE_H - 2; y++)
+        for (x = 1; x < MAZE_W - 2; x++) {
+            if (x & y & 1) { wall_clear(x, y); continue; }
+            if (!((x | y) & 1)) continue;       /* pillar */
+            if (!mask) { bits = pack_byte(); mask = 0x80; }
+            if (bits & mask) wall_clear(x, y);
+            mask >>= 1;
+        }
+
+    for (count = pack_byte(); count; count--) {
+        c = pack_cell();
+        wall[c >> 4] ^= cell_bit[c & 15];
+    }
+    return !pack_bad;
+}
+
+unsigned char pack_load(unsigned char n)
+{
+    unsigned char ok, g;
+
+    if (pack_missing || n == 0) return 0;
+    g = (n - 1) / PACK_GROUP;
+    pack_name[6] = pack_hex[g >> 4];
+    pack_name[7] = pack_hex[g & 15];
+    if (!cas_in_open(pack_name)) { pack_missing = 1; return 0; }
+    pack_bad = 0;
+    ok = pack_read(n);
+    cas_in_close();
+    return ok;
+}
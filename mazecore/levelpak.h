@@ -0,0 +1,65 @@
+/*
+ * levelpak.h - precomputed mazes read from a pack file on disc
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * The pack is written by tools/levelpack from the same mazecore
+ * code the games carve with, so a maze read from it is the maze
+ * that number would have given - except that it no longer changes
+ * if the carver does.
+ *
+ * Both carvers work on a lattice: rooms (odd x and y) are always
+ * open and pillars (even x and y) and the border always hedge, so
+ * only the slots between two rooms say anything about the maze.
+ * Those are stored one bit each, and the few cells the extra
+ * openings and the exit leave off the lattice go in a patch list.
+ * A 16x16 maze takes 11 bytes of slots instead of a 32 byte map.
+ *
+ * AMSDOS can't seek, so every byte before a record has to be read
+ * to reach it, at about 2.5K a second.  The pack is therefore cut
+ * into files of PACK_GROUP mazes each, LEVELS00.PAK for mazes 1-8
+ * to LEVELS1F.PAK for 249-255, and a maze is read from its own
+ * file past at most 7 others: about 2K at 64x64, where the whole
+ * pack is 74K.
+ *
+ * File layout, numbers little-endian, cells as CELL(x, y) in
+ * PACK_CELL bytes:
+ *   'M' 'Z' MAZE_SHIFT first count
+ *   index: count x 2 bytes, where each maze's record starts,
+ *          counted from the end of the index
+ *   record for each maze first..first+count-1:
+ *     2 bytes    layout stream state after the gems were placed,
+ *                so place_ghosts() carries on exactly as it would
+ *                after carving
+ *     exit cell, then NUM_GEMS gem cells
+ *     slot bits, 1 = open, most significant first, in the order
+ *     the cells x, y < size - 2 come row by row; padded to a byte
+ *     patch count, then that many cells to flip
+ *
+ * The records before maze n in its file are counted off, not
+ * decoded.
+ */
+
+#ifndef LEVELPAK_H
+#define LEVELPAK_H
+
+/* File for group g is PACK_FILE with g in hex in the 7th and 8th
+ * characters */
+#define PACK_FILE   "LEVELS00.PAK"
+#define PACK_GROUP  8
+
+#if MAZE_SHIFT == 4
+#define PACK_CELL   1
+#else
+#define PACK_CELL   2
+#endif
+
+/* Read maze n (1-255) into the wall map, gems and exit and leave
+ * the layout stream ready for place_ghosts().  Returns 0 if its
+ * file is missing, for another maze size or doesn't hold maze n;
+ * once the disc has failed it isn't tried again. */
+unsigned char pack_load(unsigned char n);
+
+#endif
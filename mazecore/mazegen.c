@@ -0,0 +1,306 @@
+/*
+ * mazegen.c - maze layout shared by the games and host tools
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ */
+
+#include <string.h>
+#include "rng.h"
+#include "mazegen.h"
+
+unsigned int wall[WALL_WORDS];
+
+unsigned char gems_total;
+unsigned char gem_x[NUM_GEMS], gem_y[NUM_GEMS];
+unsigned char gem_taken[NUM_GEMS];
+unsigned char exit_x, exit_y;
+
+unsigned char num_ghosts = 1;
+unsigned char ghost_x[MAX_GHOSTS], ghost_y[MAX_GHOSTS];
+unsigned char ghost_wait[MAX_GHOSTS];   /* player steps to next move */
+unsigned char occ[MAZE_W * MAZE_H];
+
+const unsigned int cell_bit[16] = {
+    0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080,
+    0x0100, 0x0200, 0x0400, 0x0800, 0x1000, 0x2000, 0x4000, 0x8000
+};
+
+const signed char dx[] = { 0, 1, 0, -1 };
+const signed char dy[] = { -1, 0, 1, 0 };
+
+/* ============================================================
+ * WALL MAP
+ * No bounds checks: the border is solid and never parted, so
+ * the player and ghosts only ever look one cell inside it.
+ * ============================================================ */
+
+unsigned char is_wall(unsigned char cx, unsigned char cy)
+{
+    return WALL_AT(CELL(cx, cy)) ? 1 : 0;
+}
+
+void wall_clear(unsigned char cx, unsigned char cy)
+{
+    cell_t c = CELL(cx, cy);
+    wall[c >> 4] &= ~cell_bit[c & 15];
+}
+
+unsigned char is_border(unsigned char cx, unsigned char cy)
+{
+    if (cx == 0 || cx == MAZE_W - 1) return 1;
+    if (cy == 0 || cy == MAZE_H - 1) return 1;
+    return 0;
+}
+
+/* Index + 1 of the untaken gem at (x, y), or 0 */
+unsigned char gem_at(unsigned char x, unsigned char y)
+{
+    unsigned char i;
+    for (i = 0; i < gems_total; i++)
+        if (gem_x[i] == x && gem_y[i] == y && !gem_taken[i])
+            return i + 1;
+    return 0;
+}
+
+/* ============================================================
+ * MAZE GENERATION
+ * Rooms are the cells with odd x and y; the cells between them
+ * are the hedges that get carved away.  Two carvers, picked at
+ * compile time:
+ *
+ *   default          recursive backtracker - the layouts the
+ *                    numbered mazes have always had.  Its stack
+ *                    can hold a quarter of the maze.
+ *   MAZE_GEN_ELLER   Eller's algorithm, one row of rooms at a
+ *                    time with only a row's worth of state.
+ *                    Different layouts from the same seed.
+ *
+ * Either way a pass of extra openings then adds loops, scaled
+ * with the area: 10 at 16x16.
+ *
+ * The carvers work a step at a time on carve_wall, so a maze can
+ * also be carved into a spare wall map a step at a time (see
+ * NEXT MAZE in play.c).  generate_maze() just runs every step.
+ * ============================================================ */
+
+#define EXTRA_GAPS (MAZE_W * MAZE_H / 25)
+
+unsigned int *carve_wall;
+unsigned int carve_gaps;        /* extra openings still to try */
+
+static unsigned char carve_is_wall(unsigned char cx, unsigned char cy)
+{
+    cell_t c = CELL(cx, cy);
+    return (carve_wall[c >> 4] & cell_bit[c & 15]) ? 1 : 0;
+}
+
+static void carve_clear(unsigned char cx, unsigned char cy)
+{
+    cell_t c = CELL(cx, cy);
+    carve_wall[c >> 4] &= ~cell_bit[c & 15];
+}
+
+#ifdef MAZE_GEN_ELLER
+
+/* Rooms per row; the last column and row stay solid, as with
+ * the backtracker */
+#define ROW_ROOMS ((MAZE_W - 2) / 2)
+
+/* Set of each room in the current row (0 = none yet), and per
+ * set id the rooms still to visit and whether it has gone down */
+unsigned char room_set[ROW_ROOMS];
+unsigned char set_left[ROW_ROOMS + 1];
+unsigned char set_down[ROW_ROOMS + 1];
+unsigned char carve_row;
+
+static void carve_start(void)
+{
+    memset(room_set, 0, sizeof(room_set));
+    carve_row = 0;
+}
+
+/* One row of rooms; 0 after the last */
+static unsigned char carve_next(void)
+{
+    unsigned char i, k, a, b, y, last;
+
+    if (carve_row == ROW_ROOMS) return 0;
+    y = carve_row * 2 + 1;
+    last = (++carve_row == ROW_ROOMS);
+
+    /* Rooms nothing came down into get the lowest free id -
+     * a row never has more sets than rooms */
+    memset(set_left, 0, sizeof(set_left));
+    for (i = 0; i < ROW_ROOMS; i++) set_left[room_set[i]] = 1;
+    k = 1;
+    for (i = 0; i < ROW_ROOMS; i++) {
+        carve_clear(i * 2 + 1, y);
+        if (room_set[i]) continue;
+        while (set_left[k]) k++;
+        room_set[i] = k; set_left[k] = 1;
+    }
+
+    /* Join neighbours in different sets at random - all of
+     * them on the last row, so everything ends up connected */
+    for (i = 0; i + 1 < ROW_ROOMS; i++) {
+        a = room_set[i]; b = room_set[i + 1];
+        if (a == b || (!last && (rng_layout() & 1))) continue;
+        carve_clear(i * 2 + 2, y);
+        for (k = 0; k < ROW_ROOMS; k++)
+            if (room_set[k] == b) room_set[k] = a;
+    }
+    if (last) return 1;
+
+    /* Each set carries on down at least once; rooms that
+     * don't go down leave their set behind */
+    memset(set_left, 0, sizeof(set_left));
+    memset(set_down, 0, sizeof(set_down));
+    for (i = 0; i < ROW_ROOMS; i++) set_left[room_set[i]]++;
+    for (i = 0; i < ROW_ROOMS; i++) {
+        a = room_set[i];
+        set_left[a]--;
+        if ((rng_layout() & 1) || (set_left[a] == 0 && !set_down[a])) {
+            carve_clear(i * 2 + 1, y + 1);
+            set_down[a] = 1;
+        } else {
+            room_set[i] = 0;
+        }
+    }
+    return 1;
+}
+
+#else
+
+#define STACK_SIZE ((MAZE_W / 2) * (MAZE_H / 2))
+unsigned char stk_x[STACK_SIZE];
+unsigned char stk_y[STACK_SIZE];
+unsigned int stk_ptr;
+
+static void carve_start(void)
+{
+    carve_clear(1, 1);
+    stk_x[0] = 1; stk_y[0] = 1;
+    stk_ptr = 1;
+}
+
+/* One room carved into, or one backed out of; 0 once the stack
+ * is empty */
+static unsigned char carve_next(void)
+{
+    unsigned char x, y, nx, ny;
+    unsigned char dirs[4];
+    unsigned char i, j, count;
+
+    if (stk_ptr == 0) return 0;
+    x = stk_x[stk_ptr - 1]; y = stk_y[stk_ptr - 1];
+    count = 0;
+    for (i = 0; i < 4; i++) {
+        nx = x + dx[i] * 2; ny = y + dy[i] * 2;
+        if (nx >= 1 && nx < MAZE_W - 1 &&
+            ny >= 1 && ny < MAZE_H - 1 &&
+            carve_is_wall(nx, ny))
+            dirs[count++] = i;
+    }
+    if (count == 0) { stk_ptr--; }
+    else {
+        j = rng_layout_below(count); i = dirs[j];
+        nx = x + dx[i] * 2; ny = y + dy[i] * 2;
+        carve_clear(x + dx[i], y + dy[i]);
+        carve_clear(nx, ny);
+        stk_x[stk_ptr] = nx; stk_y[stk_ptr] = ny; stk_ptr++;
+    }
+    return 1;
+}
+
+#endif
+
+void carve_begin(unsigned int *w)
+{
+    carve_wall = w;
+    memset(w, 0xFF, WALL_WORDS * sizeof(unsigned int));
+    carve_start();
+    carve_gaps = EXTRA_GAPS;
+}
+
+unsigned char carve_step(void)
+{
+    unsigned char x, y, count;
+
+    if (carve_next()) return 1;
+    if (carve_gaps == 0) return 0;
+    carve_gaps--;
+
+    x = rng_layout_below(MAZE_W - 4) + 2;
+    y = rng_layout_below(MAZE_H - 4) + 2;
+    if (carve_is_wall(x, y)) {
+        /* 2 <= x, y < size-2, so all four neighbours exist */
+        count = 4 - carve_is_wall(x, y - 1) - carve_is_wall(x, y + 1)
+                  - carve_is_wall(x - 1, y) - carve_is_wall(x + 1, y);
+        if (count == 2) carve_clear(x, y);
+    }
+    return 1;
+}
+
+void generate_maze(void)
+{
+    carve_begin(wall);
+    while (carve_step())
+        ;
+}
+
+/* ============================================================
+ * PLACE ITEMS
+ * Gems, exit and ghosts for the maze just carved.
+ * ============================================================ */
+
+void place_gems(void)
+{
+    unsigned char x, y;
+
+    wall_clear(START_X, START_Y);
+
+    /* gems_total counts the gems placed so far, so gem_at()
+     * only sees those */
+    for (gems_total = 0; gems_total < NUM_GEMS; gems_total++) {
+        do {
+            x = rng_layout_below(MAZE_W - 2) + 1;
+            y = rng_layout_below(MAZE_H - 2) + 1;
+        } while (is_wall(x, y) || gem_at(x, y) || (x <= 2 && y <= 2));
+        gem_x[gems_total] = x; gem_y[gems_total] = y;
+        gem_taken[gems_total] = 0;
+    }
+
+    exit_x = MAZE_W - 2; exit_y = MAZE_H - 2;
+    wall_clear(exit_x, exit_y);
+    if (is_wall(exit_x, exit_y - 1) && is_wall(exit_x - 1, exit_y))
+        wall_clear(exit_x, exit_y - 1);
+}
+
+void place_ghosts(void)
+{
+    unsigned char i, x, y, j;
+
+    /* Ghosts start away from the player, one per cell, with
+     * staggered timers so they don't all move on the same turn */
+    memset(occ, 0, sizeof(occ));
+    j = GHOST_DELAY;
+    for (i = 0; i < num_ghosts; i++) {
+        do {
+            x = rng_layout_below(MAZE_W - 4) + 2;
+            y = rng_layout_below(MAZE_H - 4) + 2;
+        } while (is_wall(x, y) || (x + y < 8) ||
+                 occ[CELL(x, y)]);
+        ghost_x[i] = x; ghost_y[i] = y;
+        ghost_wait[i] = j;
+        if (--j == 0) j = GHOST_DELAY;
+        occ[CELL(x, y)] = i + 1;
+    }
+}
+
+void place_layout(void)
+{
+    place_gems();
+    place_ghosts();
+}
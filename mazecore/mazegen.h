@@ -0,0 +1,94 @@
+/*
+ * mazegen.h - maze layout shared by the games and host tools
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * The wall map, maze carving and item placement - everything a
+ * maze number decides.  tools/levelcheck builds this same file
+ * with gcc, so it checks exactly the mazes the games play.
+ */
+
+#ifndef MAZEGEN_H
+#define MAZEGEN_H
+
+/* The maze is square with a power-of-two side, so a cell index
+ * is (y << MAZE_SHIFT) | x.  4 = 16x16, the classic layout the
+ * seeds were made for; 5 = 32x32, 6 = 64x64.  Build with
+ * -DMAZE_SHIFT=n to change it. */
+#ifndef MAZE_SHIFT
+#define MAZE_SHIFT 4
+#endif
+#if MAZE_SHIFT < 4 || MAZE_SHIFT > 6
+#error MAZE_SHIFT must be 4, 5 or 6
+#endif
+
+#define MAZE_W    (1 << MAZE_SHIFT)
+#define MAZE_H    MAZE_W
+#define NUM_GEMS   6
+
+#define DIR_N 0
+#define DIR_E 1
+#define DIR_S 2
+#define DIR_W 3
+
+#define START_X    1    /* where the player starts, facing east */
+#define START_Y    1
+
+/* Walls are one bit per cell, 16 cells per word, rows laid end
+ * to end - so a flat cell index c maps to word c >> 4, bit c & 15.
+ * 64x64 takes 512 bytes. */
+#define WALL_WORDS (MAZE_W / 16 * MAZE_H)
+#define WALL_AT(c) (wall[(c) >> 4] & cell_bit[(c) & 15])
+
+#define MAX_GHOSTS 16
+#define GHOST_DELAY 3   /* player steps per ghost step */
+
+/* Flat cell index - a byte is enough up to 16x16 */
+#if MAZE_SHIFT > 4
+typedef unsigned int cell_t;
+#else
+typedef unsigned char cell_t;
+#endif
+#define CELL(x, y) ((cell_t)(((cell_t)(y) << MAZE_SHIFT) | (x)))
+
+extern unsigned int wall[WALL_WORDS];
+
+extern unsigned char gems_total;
+extern unsigned char gem_x[NUM_GEMS], gem_y[NUM_GEMS];
+extern unsigned char gem_taken[NUM_GEMS];
+extern unsigned char exit_x, exit_y;
+
+/* Ghosts, one entry per array.  occ[] holds ghost index + 1 for
+ * each cell (0 = empty) so "is there a ghost here" is a single
+ * lookup however many ghosts there are. */
+extern unsigned char num_ghosts;
+extern unsigned char ghost_x[MAX_GHOSTS], ghost_y[MAX_GHOSTS];
+extern unsigned char ghost_wait[MAX_GHOSTS];
+extern unsigned char occ[MAZE_W * MAZE_H];
+
+extern const unsigned int cell_bit[16];
+extern const signed char dx[4], dy[4];
+
+unsigned char is_wall(unsigned char cx, unsigned char cy);
+void wall_clear(unsigned char cx, unsigned char cy);
+unsigned char is_border(unsigned char cx, unsigned char cy);
+unsigned char gem_at(unsigned char x, unsigned char y);
+
+/* All draw from the layout stream only: seed it, then call
+ * generate_maze() and place_layout().  place_layout() is
+ * place_gems() (gems and exit) then place_ghosts(), split so a
+ * maze loaded from a level pack can still have its ghosts placed */
+void generate_maze(void);
+
+/* generate_maze() a step at a time, into any wall map: a step is
+ * one room of the backtracker, a row of Eller's or one of the
+ * extra openings.  carve_step() returns 0 when the maze is done. */
+void carve_begin(unsigned int *w);
+unsigned char carve_step(void);
+void place_gems(void);
+void place_ghosts(void);
+void place_layout(void);
+
+#endif
@@ -0,0 +1,110 @@
+# Maze options shared by the games, the core library and the
+# host tools.  Include after setting CORE; any of these can be
+# given on the make command line.
+#
+#   MAZE_SHIFT=4|5|6      16x16, 32x32 or 64x64 mazes
+#   MAZE_GEN=eller        carve a row at a time (Eller's algorithm)
+#   RNG_LAYOUT=fast       xorshift for layouts too (new mazes)
+#   LEVELS=pack           read mazes from the level pack on disc
+#   AI_COST=show          show the ghost search cost each turn
+#   INPUT=record|replay|script
+#                         log the keys to KEYS.REC, play KEYS.REC
+#                         back, or play a script built into the
+#                         game (see input.h)
+#   CLIB=lean             print through the firmware's text VDU
+#                         instead of z88dk's ANSI terminal library
+#   PACE=realtime         ghosts and energy run on a clock of game
+#                         ticks, with the keys polled each tick
+#   SOUND=ay              music and sound effects on the AY chip,
+#                         played from the frame interrupt (sound.h)
+#   MAP=fog               only the cells the player has seen are
+#                         drawn (fog of war)
+#   VIEW=3d               the maze seen in 3D from the player, with
+#                         M to switch to the map and back (view3d.h)
+
+MAZE_SHIFT ?= 4
+MAZE_GEN ?= backtrack
+RNG_LAYOUT ?= compat
+LEVELS ?= carve
+AI_COST ?= hide
+INPUT ?= keys
+CLIB ?= ansi
+PACE ?= turns
+SOUND ?= none
+MAP ?= full
+VIEW ?= map
+
+# Options that change the mazes themselves
+GENFLAGS = -DMAZE_SHIFT=$(MAZE_SHIFT)
+# Options that only change the engine
+COREFLAGS =
+# One library per combination: mazecore4.lib, mazecore5ep.lib, ...
+LIBTAG =
+
+ifeq ($(MAZE_GEN),eller)
+GENFLAGS += -DMAZE_GEN_ELLER
+LIBTAG := $(LIBTAG)e
+endif
+ifeq ($(RNG_LAYOUT),fast)
+GENFLAGS += -DRNG_FAST_LAYOUT
+LIBTAG := $(LIBTAG)f
+endif
+ifeq ($(LEVELS),pack)
+COREFLAGS += -DLEVEL_PACK
+LIBTAG := $(LIBTAG)p
+endif
+ifeq ($(AI_COST),show)
+COREFLAGS += -DSHOW_AI_COST
+LIBTAG := $(LIBTAG)a
+endif
+ifeq ($(INPUT),record)
+COREFLAGS += -DKEY_RECORD
+LIBTAG := $(LIBTAG)r
+endif
+ifeq ($(INPUT),replay)
+COREFLAGS += -DKEY_REPLAY
+LIBTAG := $(LIBTAG)y
+endif
+ifeq ($(INPUT),script)
+COREFLAGS += -DKEY_SCRIPT
+LIBTAG := $(LIBTAG)s
+endif
+ifeq ($(CLIB),lean)
+CLIBFLAGS =
+COREFLAGS += -DTEXT_FIRMWARE
+LIBTAG := $(LIBTAG)l
+else
+CLIBFLAGS = -clib=ansi
+endif
+ifeq ($(PACE),realtime)
+COREFLAGS += -DREAL_TIME
+LIBTAG := $(LIBTAG)t
+endif
+
+ifeq ($(SOUND),ay)
+COREFLAGS += -DSOUND
+LIBTAG := $(LIBTAG)m
+endif
+
+ifeq ($(MAP),fog)
+COREFLAGS += -DFOG
+LIBTAG := $(LIBTAG)o
+endif
+
+ifeq ($(VIEW),3d)
+COREFLAGS += -DVIEW_3D
+LIBTAG := $(LIBTAG)v
+endif
+
+CORELIB = mazecore$(MAZE_SHIFT)$(LIBTAG)
+COREOPTS = MAZE_SHIFT=$(MAZE_SHIFT) MAZE_GEN=$(MAZE_GEN) \
+           RNG_LAYOUT=$(RNG_LAYOUT) LEVELS=$(LEVELS) AI_COST=$(AI_COST) \
+           INPUT=$(INPUT) CLIB=$(CLIB) \
+           PACE=$(PACE) SOUND=$(SOUND) \
+           MAP=$(MAP) VIEW=$(VIEW)
+
+# The library's sources for a gcc build of a game (make host), with
+# screen_host.c in place of screen_cpc.c
+CORE_HOST_SRCS = $(addprefix $(CORE)/,rng.c mazegen.c levelpak.c bcd.c \
+                 disc.c input.c task.c screen.c screen_host.c play.c \
+                 view3d.c)
@@ -0,0 +1,997 @@
+/*
+ * play.c - the maze game engine shared by both games
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "rng.h"
+#include "mazegen.h"
+#include "screen.h"
+#include "input.h"
+#include "play.h"
+#include "task.h"
+#include "sound.h"
+#include "view3d.h"
+#ifdef LEVEL_PACK
+#include "levelpak.h"
+#endif
+
+/* ============================================================
+ * GLOBAL STATE
+ * ============================================================ */
+
+unsigned char px, py, pdir;
+unsigned char energy[BCD_LEN];
+unsigned char gems_collected;
+unsigned char game_running;
+unsigned char maze_seed;
+
+const char player_ch[] = "^>v<";
+#ifdef SHOW_AI_COST
+const char hex_digit[] = "0123456789ABCDEF";
+#endif
+
+/* Previous player position for partial redraw */
+unsigned char old_px, old_py;
+
+/* ============================================================
+ * MAZE PROMPT - the end of both title screens
+ * ============================================================ */
+
+unsigned char ask_maze(unsigned char row, char *prompt)
+{
+    int key;
+    unsigned char seed;
+
+    puts(prompt);
+
+    seed = 0;
+    while (1) {
+        key = key_get();
+        if (key == 13 || key == 10) break;
+        if (key == 'q' || key == 'Q') {
+            if (confirm(row)) return 1;
+            /* They said No - clear the prompt */
+            print_at(1, row, prompt);
+            continue;
+        }
+        if (key >= '0' && key <= '9') {
+            putchar(key);
+            seed = seed * 10 + (key - '0');
+        }
+    }
+
+    if (seed == 0) {
+        rng_layout_state = 7777;
+        maze_seed = 0;
+        puts("");
+        puts("  Random maze!");
+    } else {
+        rng_layout_seed(seed);
+        maze_seed = seed;
+    }
+    rng_play_state = rng_layout_state;
+    puts("");
+    puts("  Press any key...");
+    key_get();
+    return 0;
+}
+
+#ifdef MAZE_AHEAD
+/* ============================================================
+ * NEXT MAZE - carved as a task while this one is played
+ * The carver gets its own copy of the layout stream, swapped in
+ * for each step, so the maze comes out the same as if it were
+ * carved at the start of its level.  Whatever is left is done
+ * when new_maze() asks for it.
+ * ============================================================ */
+
+unsigned int wall_next[WALL_WORDS];
+unsigned char next_seed;            /* 0 = none being carved */
+unsigned int next_rng;              /* its layout stream */
+
+/* One room or row a unit (task.h) */
+unsigned char next_slice(void)
+{
+    unsigned int keep;
+    unsigned char more;
+
+    keep = rng_layout_state;
+    rng_layout_state = next_rng;
+    more = carve_step();
+    next_rng = rng_layout_state;
+    rng_layout_state = keep;
+    return more;
+}
+
+void maze_ahead(unsigned char seed)
+{
+    unsigned int keep;
+
+    keep = rng_layout_state;
+    rng_layout_seed(seed);
+    next_rng = rng_layout_state;
+    rng_layout_state = keep;
+    next_seed = seed;
+    carve_begin(wall_next);
+    task_start(next_slice);
+}
+
+/* Finish maze_seed if it's the one being carved, with the layout
+ * stream left where carving it left it.  Anything else being
+ * carved is dropped, as generate_maze() will reuse the carver. */
+unsigned char next_take(void)
+{
+    unsigned char ok;
+
+    task_stop(next_slice);
+    ok = next_seed && next_seed == maze_seed;
+    next_seed = 0;
+    if (!ok) return 0;
+    while (next_slice())
+        ;
+    memcpy(wall, wall_next, sizeof(wall));
+    rng_layout_state = next_rng;
+    return 1;
+}
+#endif
+
+/* ============================================================
+ * NEW MAZE - walls, gems and exit for maze number maze_seed,
+ * with the layout stream already seeded.  A LEVEL_PACK build
+ * reads them from the level pack and only carves when it is
+ * missing or doesn't have that maze (maze 0 never is).
+ * ============================================================ */
+
+void new_maze(void)
+{
+#ifdef LEVEL_PACK
+    if (maze_seed && pack_load(maze_seed)) return;
+#endif
+#ifdef MAZE_AHEAD
+    if (next_take()) {
+        place_gems();
+        return;
+    }
+#endif
+    generate_maze();
+    place_gems();
+}
+
+/* ============================================================
+ * PLACE ITEMS - player and ghosts; energy is up to the game
+ * ============================================================ */
+
+void place_items(void)
+{
+    px = START_X; py = START_Y; pdir = DIR_E;
+    place_ghosts();
+
+    gems_collected = 0;
+    game_running = 1;
+    old_px = px; old_py = py;
+}
+
+/* ============================================================
+ * DISTANCE FIELD
+ * Breadth-first distances from the player over the open cells,
+ * one byte per cell indexed like the wall map.  Paths in a big
+ * maze can be longer than 255, so distances are kept mod 256 and
+ * df_seen says which cells have one.  A ghost only compares its
+ * cell with its neighbours, whose true distances differ from it
+ * by at most one, so "one step nearer" is still dist[c] - 1 in
+ * byte arithmetic.
+ *
+ * The search is lazy and resumable: it only runs when a ghost
+ * needs a step, and stops as soon as the ghost's cell has been
+ * reached.  At that point every cell nearer the player than the
+ * ghost is final, which is all the ghost's neighbour lookup
+ * needs.  The queue survives between turns, so a ghost that
+ * wanders further away just extends the same search.  Moving
+ * the player or parting a hedge starts a fresh search.
+ *
+ * One step of the player changes the true distance of nearly
+ * every cell (in a maze with few loops everything on one side
+ * gets a step nearer and everything else a step further;
+ * tools/dfcheck counts 1974 cells a step at 64x64), so the field
+ * can't be repaired in place for less than searching again.
+ * Instead the search is capped: a turn expands at most DF_TURN
+ * cells, and df_due counts the cells the turns since the search
+ * started have allowed.  A ghost the search hasn't reached within
+ * that takes the old greedy step, to the free neighbour nearest
+ * the player as the crow flies, until it has.  A 16x16 maze has
+ * about 100 open cells, so there the cap never bites; at 64x64 a
+ * player on the move is chased by the field out to about DF_TURN
+ * cells and by greed beyond.  Unused allowance doesn't pile up,
+ * so no turn expands more than DF_TURN.
+ *
+ * In REAL_TIME the field instead grows by DF_TURN every tick,
+ * needed or not, and a task (df_slice) does the next tick's share
+ * ahead in the spare time, DF_UNIT cells at a time, so the tick
+ * usually finds it done.  A
+ * ghost sees the same field however far the task has got, which
+ * keeps replays exact.
+ * ============================================================ */
+
+/* The queue only ever holds the search frontier, so above 32x32
+ * it is a ring smaller than the maze */
+#if MAZE_SHIFT > 5
+#define DF_QSIZE   1024
+#else
+#define DF_QSIZE   (MAZE_W * MAZE_H)
+#endif
+#define DF_UNIT    8                /* cells a unit of the task */
+#define DF_TURN    (16 * DF_UNIT)   /* cells the search may expand a turn */
+#define DF_SEEN(c) (df_seen[(c) >> 4] & cell_bit[(c) & 15])
+
+/* Cell index offsets for N, E, S, W.  int, not signed char, as
+ * in raytest.c: sccz80 may not sign-extend the narrow type when
+ * it is added to a cell, and -MAZE_W would step forwards. */
+const int dcell[] = { -MAZE_W, 1, MAZE_W, -1 };
+
+unsigned char dist[MAZE_W * MAZE_H];
+unsigned int  df_seen[WALL_WORDS];  /* bit set = dist[] is valid */
+cell_t df_queue[DF_QSIZE];
+unsigned int  df_head, df_tail;     /* free-running, masked on use */
+unsigned char df_px, df_py;       /* player cell the field is from */
+unsigned char df_stale;
+unsigned int  df_due;             /* df_head may go this far */
+unsigned int  df_work;            /* cells expanded this turn */
+
+void df_reset(void)
+{
+    cell_t c;
+    memset(df_seen, 0, sizeof(df_seen));
+    c = CELL(px, py);
+    df_seen[c >> 4] |= cell_bit[c & 15];
+    dist[c] = 0;
+    df_queue[0] = c;
+    df_head = 0; df_tail = 1;
+    df_px = px; df_py = py;
+    df_stale = 0;
+    df_due = 0;
+}
+
+/* Extend the search until cell 'goal' has its distance, or
+ * until it has expanded 'to' cells since it started */
+void df_grow(cell_t goal, unsigned int to)
+{
+    cell_t c, n;
+    unsigned char d, i;
+
+    if (df_stale || px != df_px || py != df_py) df_reset();
+
+    while (!DF_SEEN(goal) && df_head != df_tail && df_head < to) {
+        c = df_queue[df_head++ & (DF_QSIZE - 1)];
+        d = dist[c] + 1;
+        for (i = 0; i < 4; i++) {
+            n = c + dcell[i];
+            if (!DF_SEEN(n) && !WALL_AT(n)) {
+                df_seen[n >> 4] |= cell_bit[n & 15];
+                dist[n] = d;
+                df_queue[df_tail++ & (DF_QSIZE - 1)] = n;
+            }
+        }
+        df_work++;
+    }
+}
+
+/* This turn's share of the search */
+void df_turn(void)
+{
+    if (df_stale || px != df_px || py != df_py) df_reset();
+#ifdef REAL_TIME
+    df_due += DF_TURN;
+    df_grow(0, df_due);
+#else
+    if (df_due > df_head) df_due = df_head;
+    df_due += DF_TURN;
+#endif
+}
+
+#ifdef REAL_TIME
+/* Cell 0 is in the border, so never reached: the search just
+ * goes on, as far as the next tick will let it.  Once it has got
+ * there the task has nothing to do until the tick, and stays on
+ * for then. */
+unsigned char df_slice(void)
+{
+    unsigned int to;
+
+    if (df_stale || px != df_px || py != df_py) return 1;
+    to = df_due + DF_TURN;
+    if (df_head + DF_UNIT < to) to = df_head + DF_UNIT;
+    df_grow(0, to);
+    return 1;
+}
+#endif
+
+/* ============================================================
+ * HINT
+ * H shows the way to the nearest gem still lying about, or to
+ * the exit once they are all taken.  The distance field is
+ * already a breadth-first search from the player, with its ring
+ * of a queue and its bitset of cells reached, so the hint starts
+ * it afresh and stops at the first goal it reaches - the nearest.
+ * Walking back down the distances from there gives the path,
+ * which goes in hint_path[] (the goals are kept there during the
+ * search) and is drawn through the dirty cells.  It comes off
+ * again at the next key.
+ *
+ * The search is capped like a turn of the ghosts' search, at
+ * HINT_MAX cells, and the path is no longer than that, so a hint
+ * costs no more than such a turn.  A 16x16 maze is carved with
+ * 105 open cells at most, so there it finds the nearest goal
+ * unless a score of hedges have been parted; in a bigger maze a
+ * goal further off isn't shown.  The field is left as the ghosts
+ * would have it.
+ * ============================================================ */
+
+#define HINT_MAX    DF_TURN
+#define HINT_AT(c)  (hint_path[(c) >> 4] & cell_bit[(c) & 15])
+#define HINT_SET(c) (hint_path[(c) >> 4] |= cell_bit[(c) & 15])
+
+unsigned int  hint_path[WALL_WORDS];
+unsigned char hint_on;
+
+/* Take the path off, redrawing what's in view */
+void hint_clear(void)
+{
+    unsigned char x, y;
+
+    if (!hint_on) return;
+    hint_on = 0;
+    for (y = cam_y; y < cam_y + VIEW_H; y++)
+        for (x = cam_x; x < cam_x + VIEW_W; x++)
+            if (HINT_AT(CELL(x, y))) mark_cell(x, y);
+    memset(hint_path, 0, sizeof(hint_path));
+}
+
+/* HINT_SHOWN with the path shown, else HINT_NONE if no goal can
+ * be reached or HINT_FAR if none is within HINT_MAX cells */
+#define HINT_NONE   0
+#define HINT_SHOWN  1
+#define HINT_FAR    2
+
+unsigned char hint_show(void)
+{
+    cell_t c, n, goal, home;
+    unsigned char d, i;
+
+    hint_clear();
+    for (i = 0; i < gems_total; i++)
+        if (!gem_taken[i]) HINT_SET(CELL(gem_x[i], gem_y[i]));
+    if (gems_collected >= gems_total) HINT_SET(CELL(exit_x, exit_y));
+
+    df_reset();
+    goal = 0;
+    while (!goal && df_head != df_tail && df_head < HINT_MAX) {
+        c = df_queue[df_head++ & (DF_QSIZE - 1)];
+        d = dist[c] + 1;
+        for (i = 0; i < 4; i++) {
+            n = c + dcell[i];
+            if (!DF_SEEN(n) && !WALL_AT(n)) {
+                df_seen[n >> 4] |= cell_bit[n & 15];
+                dist[n] = d;
+                df_queue[df_tail++ & (DF_QSIZE - 1)] = n;
+                if (HINT_AT(n)) goal = n;
+            }
+        }
+        df_work++;
+    }
+    df_due = df_head;
+    memset(hint_path, 0, sizeof(hint_path));
+    if (!goal) return df_head == df_tail ? HINT_NONE : HINT_FAR;
+
+    /* Back to the player, one step nearer each time */
+    home = CELL(px, py);
+    for (c = goal; c != home; c = n) {
+        HINT_SET(c);
+        mark_cell(c & (MAZE_W - 1), c >> MAZE_SHIFT);
+        d = dist[c] - 1;
+        for (i = 0; i < 4; i++) {
+            n = c + dcell[i];
+            if (DF_SEEN(n) && dist[n] == d) break;
+        }
+    }
+    hint_on = 1;
+    return HINT_SHOWN;
+}
+
+#ifdef FOG
+/* ============================================================
+ * FOG OF WAR (MAP=fog)
+ * Only cells the player has seen are drawn; the rest stay blank,
+ * ghosts and all.  revealed[] has a bit for each, like wall[],
+ * cleared for each maze.  After a move reveal() looks along the
+ * four directions from the player, up to REVEAL_R cells or the
+ * first hedge, taking in the cells either side of each as well
+ * so openings show.  Only cells seen for the first time are
+ * marked dirty, so a move draws at most 4 * REVEAL_R * 3 cells,
+ * usually a handful, and a maze starts from the blank screen
+ * instead of a full draw.
+ * ============================================================ */
+
+#define REVEAL_R    4
+#define REVEALED(c) (revealed[(c) >> 4] & cell_bit[(c) & 15])
+
+unsigned int revealed[WALL_WORDS];
+
+void reveal_cell(cell_t c)
+{
+    if (REVEALED(c)) return;
+    revealed[c >> 4] |= cell_bit[c & 15];
+    mark_cell(c & (MAZE_W - 1), c >> MAZE_SHIFT);
+}
+
+/* The border is all hedge, so no look goes past it */
+void reveal(void)
+{
+    cell_t c;
+    int side;                   /* a dcell[] offset, so int too */
+    unsigned char i, r;
+
+    reveal_cell(CELL(px, py));
+    for (i = 0; i < 4; i++) {
+        c = CELL(px, py);
+        side = dcell[(i + 1) & 3];
+        for (r = 0; r < REVEAL_R; r++) {
+            c += dcell[i];
+            reveal_cell(c);
+            if (WALL_AT(c)) break;
+            reveal_cell(c + side);
+            reveal_cell(c - side);
+        }
+    }
+}
+#endif
+
+/* ============================================================
+ * DRAWING
+ * Cells are given in maze coordinates; the view's top-left cell
+ * (cam_x, cam_y) is subtracted to find the screen position.
+ * ============================================================ */
+
+unsigned char cam_x, cam_y;
+
+/* (x, y) must be inside the view */
+void draw_cell(unsigned char x, unsigned char y)
+{
+    char ch;
+    if (x == px && y == py) {
+        ch = player_ch[pdir];
+#ifdef FOG
+    } else if (!REVEALED(CELL(x, y))) {
+        ch = (hint_on && HINT_AT(CELL(x, y))) ? '+' : ' ';
+#endif
+    } else if (occ[CELL(x, y)]) {
+        ch = 'G';
+    } else if (is_wall(x, y)) {
+        ch = '#';
+    } else if (gem_at(x, y)) {
+        ch = '*';
+    } else if (x == exit_x && y == exit_y) {
+        ch = 'E';
+    } else if (hint_on && HINT_AT(CELL(x, y))) {
+        ch = '+';
+    } else {
+        ch = '.';
+    }
+    put_glyph(x - cam_x, y - cam_y + 1, ch);
+}
+
+void draw_map(void)
+{
+    unsigned char x, y;
+    for (y = cam_y; y < cam_y + VIEW_H; y++)
+        for (x = cam_x; x < cam_x + VIEW_W; x++)
+            draw_cell(x, y);
+}
+
+/* ============================================================
+ * REDRAW BATCHING
+ * Changes made during a turn only mark cells and status fields
+ * dirty; flush_dirty() draws each one once at the end of the
+ * turn, walking rows top to bottom so writes go in screen
+ * address order.  A cell marked twice is still drawn once.
+ * Cells outside the view are never marked; they are drawn when
+ * they scroll in.  The game draws its own status fields from
+ * dirty_fields; the engine only draws the message line.
+ * ============================================================ */
+
+unsigned int dirty[WALL_WORDS];   /* one bit per cell, like wall[] */
+unsigned char dirty_cells;        /* any bit set in dirty[] */
+unsigned char dirty_fields;
+char *msg_text;
+
+void mark_cell(unsigned char x, unsigned char y)
+{
+    cell_t c;
+#ifdef VIEW_3D
+    /* Nothing to draw, but view3d_draw() should look again */
+    if (view_3d) {
+        dirty_cells = 1;
+        return;
+    }
+#endif
+    if ((unsigned char)(x - cam_x) >= VIEW_W) return;
+    if ((unsigned char)(y - cam_y) >= VIEW_H) return;
+    c = CELL(x, y);
+    dirty[c >> 4] |= cell_bit[c & 15];
+    dirty_cells = 1;
+}
+
+void set_msg(char *s)
+{
+    msg_text = s;
+    dirty_fields |= DF_MSG;
+}
+
+/* Cost is packed BCD; energy bottoms out at zero */
+void use_energy(unsigned int cost)
+{
+    bcd_sub_k(energy, cost);
+    dirty_fields |= DF_ENERGY;
+}
+
+void update_map(void)
+{
+    mark_cell(old_px, old_py);
+    mark_cell(px, py);
+}
+
+void flush_dirty(void)
+{
+    unsigned char x, y, cx;
+    unsigned int bits, *row;
+
+#ifdef VIEW_3D
+    if (view_3d) {
+        dirty_cells = 0;
+        view3d_draw();
+    }
+#endif
+    for (y = cam_y; dirty_cells && y < cam_y + VIEW_H; y++) {
+        row = dirty + ((unsigned int)y << (MAZE_SHIFT - 4));
+        for (x = 0; x < MAZE_W; x += 16, row++) {
+            bits = *row;
+            if (bits == 0) continue;
+            *row = 0;
+            for (cx = x; bits; cx++, bits >>= 1)
+                if (bits & 1) draw_cell(cx, y);
+        }
+    }
+    dirty_cells = 0;
+
+    draw_fields();
+    if (dirty_fields & DF_MSG)
+        print_at(1, 23, msg_text);
+    dirty_fields = 0;
+}
+
+/* ============================================================
+ * VIEWPORT
+ * A maze bigger than the view scrolls one cell at a time when
+ * the player comes within VIEW_MARGIN of an edge.  The map is
+ * moved by the CRTC start address - 2 bytes for a column, 80
+ * for a row - and only the row or column coming into view is
+ * drawn.  The status rows move with it, so they are cleared and
+ * drawn again: a fixed cost whatever the size of the view.
+ * ============================================================ */
+
+/* Player as near the middle as the maze edges allow */
+void view_centre(void)
+{
+    cam_x = 0; cam_y = 0;
+#if MAZE_W > VIEW_W
+    if (px > VIEW_W / 2) cam_x = px - VIEW_W / 2;
+    if (cam_x > MAZE_W - VIEW_W) cam_x = MAZE_W - VIEW_W;
+#endif
+#if MAZE_H > VIEW_H
+    if (py > VIEW_H / 2) cam_y = py - VIEW_H / 2;
+    if (cam_y > MAZE_H - VIEW_H) cam_y = MAZE_H - VIEW_H;
+#endif
+}
+
+#if MAZE_W > VIEW_W || MAZE_H > VIEW_H
+/* Everything but the map rows - rows VIEW_H+1 to 24, the 48
+ * unseen bytes and row 0 - is one run round the block */
+void view_moved(void)
+{
+    scr_blank(row_off[VIEW_H + 1], SCR_LINE - VIEW_H * 80);
+    draw_status();
+}
+#endif
+
+#if MAZE_W > VIEW_W
+/* dir 1: view moves right, so the picture moves left */
+void scroll_x(signed char dir)
+{
+    unsigned char x, y;
+
+    scr_set_offset(scr_offset + (dir << 1));
+    cam_x += dir;
+    x = (dir > 0) ? cam_x + VIEW_W - 1 : cam_x;
+    for (y = cam_y; y < cam_y + VIEW_H; y++)
+        draw_cell(x, y);
+    view_moved();
+}
+#endif
+
+#if MAZE_H > VIEW_H
+/* dir 1: view moves down, so the picture moves up.  Rows 0 and
+ * VIEW_H+1 are kept blank, so the row scrolling in needs no
+ * clearing past the map's right edge. */
+void scroll_y(signed char dir)
+{
+    unsigned char x, y;
+
+    scr_set_offset(scr_offset + dir * 80);
+    cam_y += dir;
+    y = (dir > 0) ? cam_y + VIEW_H - 1 : cam_y;
+    for (x = cam_x; x < cam_x + VIEW_W; x++)
+        draw_cell(x, y);
+    view_moved();
+}
+#endif
+
+/* Called once the player has moved and before anything else is
+ * marked dirty that turn, so no pending mark is left pointing
+ * at where a cell used to be on screen */
+void view_follow(void)
+{
+#ifdef VIEW_3D
+    if (view_3d) return;        /* view_show() centres it */
+#endif
+#if MAZE_W > VIEW_W
+    if (px < cam_x + VIEW_MARGIN && cam_x > 0)
+        scroll_x(-1);
+    else if (px >= cam_x + VIEW_W - VIEW_MARGIN && cam_x < MAZE_W - VIEW_W)
+        scroll_x(1);
+#endif
+#if MAZE_H > VIEW_H
+    if (py < cam_y + VIEW_MARGIN && cam_y > 0)
+        scroll_y(-1);
+    else if (py >= cam_y + VIEW_H - VIEW_MARGIN && cam_y < MAZE_H - VIEW_H)
+        scroll_y(1);
+#endif
+}
+
+#ifdef VIEW_3D
+/* ============================================================
+ * 3D VIEW (VIEW=3d)
+ * The map rows show either the map or view3d.c's picture.  While
+ * it is 3D the camera stays put and cells aren't drawn; marking
+ * one only says the picture may need bringing up to date, which
+ * flush_dirty() leaves to view3d_draw().  Switching redraws the
+ * rows once for the view chosen: the map blanks them and draws
+ * every cell round the player, the 3D view paints every column.
+ * ============================================================ */
+
+unsigned char view_3d = 1;
+
+void view_show(unsigned char v)
+{
+    view_3d = v;
+    if (v) {
+        view3d_reset();         /* painted by the next flush */
+    } else {
+        scr_blank(row_off[1], VIEW_H * 80);
+        view_centre();
+        draw_map();
+    }
+}
+#endif
+
+/* ============================================================
+ * GHOST AI
+ * Only ghosts that actually move touch the screen: each step
+ * marks its old and new cell dirty, so redraw cost follows the
+ * number of moving ghosts, not the number of ghosts.
+ * ============================================================ */
+
+void move_ghost(unsigned char g)
+{
+    unsigned char best_dir, d, i, x, y, far, best;
+    cell_t c, n;
+
+    c = CELL(ghost_x[g], ghost_y[g]);
+    best_dir = 0;
+
+    if ((rng_play() & 3) == 0) {
+        i = rng_play() & 3;
+        n = c + dcell[i];
+        if (!WALL_AT(n) && !occ[n])
+            best_dir = i + 1;
+    }
+
+    /* Step to the first free neighbour one nearer the player.
+     * Walls are never reached, so no separate wall test is needed. */
+    if (!best_dir) {
+        df_grow(c, df_due);
+        if (DF_SEEN(c)) {
+            d = dist[c] - 1;
+            for (i = 0; i < 4; i++) {
+                n = c + dcell[i];
+                if (DF_SEEN(n) && dist[n] == d && !occ[n]) {
+                    best_dir = i + 1;
+                    break;
+                }
+            }
+        } else if (df_head != df_tail) {
+            /* Not reached yet: the free neighbour nearest the
+             * player as the crow flies */
+            best = 255;
+            for (i = 0; i < 4; i++) {
+                n = c + dcell[i];
+                if (WALL_AT(n) || occ[n]) continue;
+                x = ghost_x[g] + dx[i]; y = ghost_y[g] + dy[i];
+                far = (x > px ? x - px : px - x) +
+                      (y > py ? y - py : py - y);
+                if (far < best) {
+                    best = far;
+                    best_dir = i + 1;
+                }
+            }
+        }                           /* else cut off from the player */
+        if (!best_dir) return;
+    }
+
+    i = best_dir - 1;
+    mark_cell(ghost_x[g], ghost_y[g]);
+    occ[c] = 0;
+    ghost_x[g] += dx[i]; ghost_y[g] += dy[i];
+    occ[c + dcell[i]] = g + 1;
+    mark_cell(ghost_x[g], ghost_y[g]);
+}
+
+/* Called once per turn; ghosts only count turns where the
+ * player took a step.  In REAL_TIME every tick is a step. */
+void move_ghosts(unsigned char steps)
+{
+    unsigned char g;
+    if (!steps) return;
+    df_turn();
+    for (g = 0; g < num_ghosts; g++) {
+        if (--ghost_wait[g]) continue;
+        ghost_wait[g] = GHOST_DELAY;
+        move_ghost(g);
+    }
+}
+
+/* ============================================================
+ * PLAY
+ * One maze from a clean screen to its end; the game decides
+ * what the end means.
+ * ============================================================ */
+
+#ifdef REAL_TIME
+unsigned char drain_wait;       /* ticks to the next point drained */
+#endif
+
+void play_start(void)
+{
+    scr_clear();
+    memset(dirty, 0, sizeof(dirty));
+    dirty_cells = 0;
+    hint_on = 0;
+    memset(hint_path, 0, sizeof(hint_path));
+#ifdef REAL_TIME
+    drain_wait = DRAIN_TICKS;
+    task_start(df_slice);
+#endif
+    msg_text = "                       ";
+    df_stale = 1;
+    view_centre();
+#ifdef FOG
+    /* The screen is blank already: just what can be seen */
+    memset(revealed, 0, sizeof(revealed));
+    reveal();
+#endif
+#ifdef VIEW_3D
+    /* Drawn by draw_status()'s flush */
+    if (view_3d)
+        view3d_reset();
+#ifndef FOG
+    else
+        draw_map();
+#endif
+#elif !defined(FOG)
+    draw_map();
+#endif
+    draw_status();
+}
+
+unsigned char play_maze(void)
+{
+    int key;
+    unsigned char nx, ny;
+    unsigned char i, steps;
+
+    while (game_running) {
+#ifdef REAL_TIME
+        key = key_tick();
+#else
+        key = key_get();
+#endif
+
+        /* Save old position for partial redraw */
+        old_px = px; old_py = py;
+        steps = 0;
+
+        switch (key) {
+            case 'w': case 'W':
+                nx = px + dx[pdir]; ny = py + dy[pdir];
+                if (!is_wall(nx, ny)) {
+                    px = nx; py = ny;
+                    use_energy(0x02);
+                    steps++;
+                }
+                break;
+
+            case 's': case 'S':
+                nx = px - dx[pdir]; ny = py - dy[pdir];
+                if (!is_wall(nx, ny)) {
+                    px = nx; py = ny;
+                    use_energy(0x02);
+                    steps++;
+                }
+                break;
+
+            case 'a': case 'A':
+                pdir = (pdir + 3) & 3;
+                use_energy(0x01);
+                dirty_fields |= DF_DIR;
+                break;
+
+            case 'd': case 'D':
+                pdir = (pdir + 1) & 3;
+                use_energy(0x01);
+                dirty_fields |= DF_DIR;
+                break;
+
+            case 'p': case 'P':
+                nx = px + dx[pdir];
+                ny = py + dy[pdir];
+                if (is_wall(nx, ny) && !is_border(nx, ny) && bcd_cmp_k(energy, 0x50) > 0) {
+                    wall_clear(nx, ny);
+                    px = nx; py = ny;
+                    use_energy(0x50);
+                    steps++;
+                    df_stale = 1;     /* new path through the hedge */
+                    set_msg("* Hedge parted! -50 *  ");
+                    snd_sfx(SFX_HEDGE);
+                } else if (is_border(nx, ny)) {
+                    set_msg("Can't part the border! ");
+                } else if (bcd_cmp_k(energy, 0x50) <= 0) {
+                    set_msg("Not enough energy!     ");
+                } else {
+                    set_msg("No hedge ahead!        ");
+                }
+                break;
+
+            case 'h': case 'H':
+#ifdef VIEW_3D
+                /* The way is shown on the map */
+                if (view_3d) view_show(0);
+#endif
+                switch (hint_show()) {
+                    case HINT_SHOWN:
+                        set_msg("* Follow the + *       ");
+                        break;
+                    case HINT_FAR:
+                        set_msg("Nothing near enough!   ");
+                        break;
+                    default:
+                        set_msg("No way through!        ");
+                }
+                break;
+
+#ifdef VIEW_3D
+            case 'm': case 'M':
+                view_show(!view_3d);
+                break;
+#endif
+
+            case 'q': case 'Q':
+                if (confirm(23)) {
+                    game_running = 0;
+                    return PLAY_QUIT;
+                }
+                /* They said No - clear prompt and continue */
+                set_msg("                       ");
+                flush_dirty();
+                continue;
+
+            default:
+#ifdef REAL_TIME
+                key = 0;        /* the clock runs on regardless */
+                break;
+#else
+                continue;
+#endif
+        }
+
+        /* Check gem pickup, and the exit, unless idle */
+        i = key ? gem_at(px, py) : 0;
+        if (i) {
+            gem_taken[i - 1] = 1;
+            gems_collected++;
+            dirty_fields |= DF_GEMS;
+            set_msg("** GEM FOUND! **       ");
+            snd_sfx(SFX_GEM);
+        }
+
+        /* Check exit */
+        if (key && px == exit_x && py == exit_y) {
+            if (gems_collected >= gems_total)
+                return PLAY_ESCAPED;
+            set_msg("Find all gems first!   ");
+        }
+
+        /* Keep the player inside the view */
+        view_follow();
+
+#ifdef FOG
+        if (px != old_px || py != old_py)
+            reveal();
+#endif
+
+        /* A hint lasts until the next key */
+        if (key && key != 'h' && key != 'H')
+            hint_clear();
+
+#ifdef REAL_TIME
+        /* Each ghost moves every GHOST_DELAY ticks, and energy
+         * drains on the clock as well as with each move */
+        move_ghosts(1);
+        if (--drain_wait == 0) {
+            drain_wait = DRAIN_TICKS;
+            use_energy(0x01);
+        }
+#else
+        /* Each ghost moves every GHOST_DELAY player steps */
+        move_ghosts(steps);
+#endif
+
+        /* Ghost collision */
+        if (occ[CELL(px, py)]) {
+            use_energy(0x50);
+            set_msg("!! GHOST !! -50 energy ");
+            snd_sfx(SFX_GHOST);
+            nx = px - dx[pdir]; ny = py - dy[pdir];
+            if (!is_wall(nx, ny)) { px = nx; py = ny; }
+        }
+
+        /* Check energy */
+        if (bcd_is_zero(energy))
+            return PLAY_DEAD;
+
+        /* Partial redraw - one batched flush per turn */
+#ifdef REAL_TIME
+        /* ... and only for a tick that changed something */
+        if (key || px != old_px || py != old_py)
+            update_map();
+        if (!dirty_cells && !dirty_fields)
+            continue;
+#else
+        update_map();
+#endif
+        flush_dirty();
+
+#ifdef SHOW_AI_COST
+        /* Distance-field cells expanded this turn, in hex */
+        print_at(1, 25, "BFS:");
+        put_glyph(5, 24, hex_digit[(df_work >> 8) & 15]);
+        put_glyph(6, 24, hex_digit[(df_work >> 4) & 15]);
+        put_glyph(7, 24, hex_digit[df_work & 15]);
+        df_work = 0;
+#endif
+    }
+
+    return PLAY_QUIT;
+}
@@ -0,0 +1,114 @@
+/*
+ * play.h - the maze game engine shared by both games
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * Movement, hedge parting, gems, ghosts, the scrolling map view
+ * and batched redraws.  A game supplies its title and end screens,
+ * what happens at the exit, and the status area below the map
+ * through draw_status() and draw_fields().
+ */
+
+#ifndef PLAY_H
+#define PLAY_H
+
+#include "bcd.h"
+
+/* The part of the maze on screen: all of it when it fits in
+ * 40x16 characters, otherwise a window that follows the player */
+#if MAZE_W > 40
+#define VIEW_W    40
+#else
+#define VIEW_W    MAZE_W
+#endif
+#if MAZE_H > 16
+#define VIEW_H    16
+#else
+#define VIEW_H    MAZE_H
+#endif
+#define VIEW_MARGIN 4   /* cells kept between player and view edge */
+
+/* REAL_TIME: the game runs on a clock of TICK_FRAMES (input.h) a
+ * tick, one move a tick at most, whether or not a key is pressed */
+#define DRAIN_TICKS 16  /* ticks per point of energy drained */
+
+/* Status fields waiting to be redrawn.  DF_MSG is drawn by the
+ * engine on row 23; the rest by the game's draw_fields(), which
+ * can use DF_GAME and up for fields of its own. */
+#define DF_ENERGY  1
+#define DF_GEMS    2
+#define DF_DIR     4
+#define DF_MSG     8
+#define DF_GAME   16
+#define DF_ALL  0xFF
+
+/* What ended play_maze() */
+#define PLAY_QUIT     0
+#define PLAY_ESCAPED  1   /* reached the exit with every gem */
+#define PLAY_DEAD     2   /* energy ran out */
+
+extern unsigned char px, py, pdir;
+extern unsigned char energy[BCD_LEN];
+extern unsigned char gems_collected;  /* one BCD digit: NUM_GEMS < 10 */
+extern unsigned char game_running;
+extern unsigned char maze_seed;
+extern unsigned char old_px, old_py;
+
+extern unsigned char cam_x, cam_y;
+extern unsigned char dirty_fields;
+extern char *msg_text;
+extern unsigned char df_stale;
+
+/* Supplied by the game.  draw_status() draws the labels, forgets
+ * what its fields show, sets dirty_fields = DF_ALL and calls
+ * flush_dirty(); draw_fields() draws those marked in
+ * dirty_fields. */
+void draw_status(void);
+void draw_fields(void);
+
+/* Title screen prompt: puts the prompt, reads a maze number and
+ * seeds both streams from it (ENTER alone = random maze), or
+ * returns 1 if Q was confirmed on row 'row' */
+unsigned char ask_maze(unsigned char row, char *prompt);
+
+/* Walls, gems and exit for maze maze_seed, from the level pack
+ * in a LEVEL_PACK build; then place_items() for the player and
+ * ghosts.  Energy is left to the game. */
+void new_maze(void);
+void place_items(void);
+
+/* REAL_TIME: start carving maze 'seed' in the background during
+ * play, for new_maze() to pick up once maze_seed is set to it.
+ * Not with a level pack, which has its mazes ready anyway. */
+#if defined(REAL_TIME) && !defined(LEVEL_PACK)
+#define MAZE_AHEAD
+void maze_ahead(unsigned char seed);
+#endif
+
+/* VIEW=3d: the map rows show the maze in 3D (view3d.h) while
+ * view_3d is set; view_show() switches between that and the map,
+ * redrawing the rows for the one chosen.  Play starts in 3D and
+ * the choice is kept from one maze to the next. */
+#ifdef VIEW_3D
+extern unsigned char view_3d;
+void view_show(unsigned char v);
+#endif
+
+/* Cell index offsets for N, E, S, W */
+extern const int dcell[4];
+
+void draw_map(void);
+void mark_cell(unsigned char x, unsigned char y);
+void set_msg(char *s);
+void use_energy(unsigned int cost);
+void flush_dirty(void);
+void view_centre(void);
+
+/* Clear the screen and draw the maze and status from scratch,
+ * then play until the player quits, escapes or runs out */
+void play_start(void);
+unsigned char play_maze(void);
+
+#endif
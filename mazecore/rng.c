@@ -0,0 +1,100 @@
+/*
+ * rng.c - random number streams for the maze games
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ */
+
+#include "rng.h"
+
+unsigned int rng_layout_state = 1;
+unsigned int rng_play_state = 1;
+
+/* xorshift 7,9,8: every non-zero 16-bit state in one cycle, and
+ * the shifts by 8 and 9 are byte moves on the Z80.  x is short so
+ * it stays 16 bits when built with a host compiler too. */
+static unsigned int xorshift(unsigned short x)
+{
+    x ^= x << 7;
+    x ^= x >> 9;
+    x ^= x << 8;
+    return x;
+}
+
+/* n * 257 + 1, as the games have always done it.  For 255 that
+ * wraps to 0, where both generators stick (the gem placement
+ * used to spin forever), so 255 gets 0xFFFF, which no other
+ * maze number reaches. */
+void rng_layout_seed(unsigned char n)
+{
+    unsigned short s;
+    s = (unsigned int)n * 257 + 1;
+    if (s == 0) s = 0xFFFF;
+    rng_layout_state = s;
+}
+
+/* Smallest all-ones mask covering n - 1 */
+static unsigned char below_mask(unsigned char n)
+{
+    n--;
+    n |= n >> 1;
+    n |= n >> 2;
+    n |= n >> 4;
+    return n;
+}
+
+unsigned char rng_play(void)
+{
+    rng_play_state = xorshift(rng_play_state);
+    return (unsigned char)rng_play_state;
+}
+
+/* Mask and retry rather than %: no divide, no bias, and fewer
+ * than two draws on average */
+unsigned char rng_play_below(unsigned char n)
+{
+    unsigned char m, r;
+    m = below_mask(n);
+    do {
+        r = rng_play() & m;
+    } while (r >= n);
+    return r;
+}
+
+#ifdef RNG_FAST_LAYOUT
+
+unsigned char rng_layout(void)
+{
+    rng_layout_state = xorshift(rng_layout_state);
+    return (unsigned char)rng_layout_state;
+}
+
+unsigned char rng_layout_below(unsigned char n)
+{
+    unsigned char m, r;
+    m = below_mask(n);
+    do {
+        r = rng_layout() & m;
+    } while (r >= n);
+    return r;
+}
+
+#else
+
+/* The original generator - four taps, one bit per call */
+unsigned char rng_layout(void)
+{
+    unsigned char bit;
+    bit = ((rng_layout_state >> 0) ^ (rng_layout_state >> 2) ^
+           (rng_layout_state >> 3) ^ (rng_layout_state >> 5)) & 1;
+    rng_layout_state = (rng_layout_state >> 1) | (bit << 15);
+    return (unsigned char)(rng_layout_state & 0xFF);
+}
+
+unsigned char rng_layout_below(unsigned char n)
+{
+    return rng_layout() % n;
+}
+
+#endif
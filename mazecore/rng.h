@@ -0,0 +1,41 @@
+/*
+ * rng.h - random number streams for the maze games
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * Two independent streams, so nothing that happens during play
+ * can change the maze a seed produces:
+ *
+ *   layout - maze carving and item placement
+ *   play   - ghost wandering, picking the next maze, ...
+ *
+ * Seed a stream by setting its state, which must not be 0, or
+ * the layout stream from a maze number with rng_layout_seed().
+ *
+ * The play stream is a 16-bit xorshift.  By default the layout
+ * stream is still the original LFSR, bounded with %, so seeds
+ * 1-255 keep giving the mazes they always have.  Build with
+ * -DRNG_FAST_LAYOUT to use xorshift for layouts too (the seeds
+ * then give new mazes).
+ */
+
+#ifndef RNG_H
+#define RNG_H
+
+extern unsigned int rng_layout_state;
+extern unsigned int rng_play_state;
+
+/* Layout state for maze number n (1-255) */
+void rng_layout_seed(unsigned char n);
+
+/* Next byte from a stream */
+unsigned char rng_layout(void);
+unsigned char rng_play(void);
+
+/* 0 .. n-1, n from 1 to 255 */
+unsigned char rng_layout_below(unsigned char n);
+unsigned char rng_play_below(unsigned char n);
+
+#endif
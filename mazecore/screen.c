@@ -0,0 +1,87 @@
+/*
+ * screen.c - text drawing shared by every platform
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * Built on put_glyph() and crtc_set_start() from the platform
+ * file (screen_cpc.c or screen_host.c).
+ */
+
+#include "screen.h"
+#include "input.h"
+
+/* ============================================================
+ * DISPLAY START
+ * ============================================================ */
+
+/* Offset of each character row's top line in its 2K block,
+ * before wrapping */
+unsigned int scr_offset;
+unsigned int row_off[SCR_ROWS];
+
+/* Move the display start to byte offset off (even) */
+void scr_set_offset(unsigned int off)
+{
+    unsigned char r;
+    off &= SCR_LINE - 2;
+    scr_offset = off;
+    for (r = 0; r < SCR_ROWS; r++) {
+        row_off[r] = off;
+        off += 80;
+    }
+    crtc_set_start(scr_offset >> 1);
+}
+
+/* ============================================================
+ * TEXT
+ * ============================================================ */
+
+/* x, y are 1-based like the old ANSI cursor positions */
+void print_at(unsigned char x, unsigned char y, char *s)
+{
+    x--; y--;
+    while (*s) { put_glyph(x++, y, *s); s++; }
+}
+
+/* Draw the low 'width' digits of n right-aligned from 0-based
+ * col, blanking leading zeros.  shown[] remembers what is on
+ * screen so only digit cells that changed are redrawn; zero it
+ * after clearing the screen. */
+void draw_bcd(unsigned char col, unsigned char row, unsigned char *n,
+              char *shown, unsigned char width)
+{
+    unsigned char k, d, lead;
+    char ch;
+    lead = 1;
+    k = width;
+    while (k--) {
+        d = n[k >> 1];
+        if (k & 1) d >>= 4;
+        d &= 0x0F;
+        if (d || k == 0) lead = 0;
+        ch = lead ? ' ' : '0' + d;
+        if (*shown != ch) {
+            *shown = ch;
+            put_glyph(col, row, ch);
+        }
+        shown++; col++;
+    }
+}
+
+/* ============================================================
+ * CONFIRM PROMPT - "Are you sure? Y/N"
+ * Returns 1 if Y, 0 if N
+ * ============================================================ */
+
+unsigned char confirm(unsigned char row)
+{
+    int key;
+    print_at(1, row, "Are you sure? (Y/N)    ");
+    while (1) {
+        key = key_get();
+        if (key == 'y' || key == 'Y') return 1;
+        if (key == 'n' || key == 'N') return 0;
+    }
+}
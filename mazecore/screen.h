@@ -0,0 +1,95 @@
+/*
+ * screen.h - Mode 1 text engine for the maze games
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * This is the platform layer: all the engine and games need from
+ * the machine is keys, glyphs on a 40x25 grid and a display start
+ * to scroll it with.  Title and end screens are plain text through
+ * stdio (cls(), puts, printf).
+ *
+ *   screen_cpc.c   the CPC: Mode 1 screen memory and the CRTC,
+ *                  keys from the firmware
+ *   screen_host.c  gcc with -DHOST: the grid is kept in memory,
+ *                  keys come from stdin, and it is shown in the
+ *                  terminal when there is one
+ *
+ * screen.c has the parts built on those that are the same for
+ * both.  The grid is addressed as on the CPC - two bytes per
+ * character in a 2K block that wraps - so scrolling behaves the
+ * same everywhere.
+ */
+
+#ifndef SCREEN_H
+#define SCREEN_H
+
+#define SCR_LINE   0x800u     /* bytes per pixel line block */
+#define SCR_COLS   40
+#define SCR_ROWS   25
+
+/* Wait for a key on the keyboard and return it.  The games read
+ * keys with key_get() (input.h), which can replay them instead. */
+#ifdef HOST
+#define __z88dk_fastcall
+int key_read(void);
+#else
+extern int fgetc_cons(void);
+#define key_read fgetc_cons
+#endif
+
+#ifdef REAL_TIME
+/* Frames (1/50 s) counted since the start, for the game clock,
+ * and the key pressed since the last call or 0, without waiting */
+unsigned int frame_count(void);
+int key_scan(void);
+#endif
+
+#if (defined(REAL_TIME) || defined(SOUND)) && !defined(HOST)
+/* The game clock and the sound player run from the firmware's
+ * frame flyback event, whose block and the code it calls have to
+ * be in the central 32K: FLY_HOOK, just below HIMEM, is kept for
+ * them.  Hooked by key_init() and unhooked by key_done(). */
+#define FLY_HOOK    0xA660u
+
+void fly_init(void);
+void fly_done(void);
+#else
+#define fly_init()
+#define fly_done()
+#endif
+
+/* Offset of each character row's top line in its 2K block */
+extern unsigned int scr_offset;
+extern unsigned int row_off[SCR_ROWS];
+
+void crtc_set_start(unsigned int words) __z88dk_fastcall;
+void cls(void);
+
+void scr_set_offset(unsigned int off);
+void scr_clear(void);
+void scr_blank(unsigned int off, unsigned int len);
+void put_glyph(unsigned char col, unsigned char row, unsigned char ch);
+void print_at(unsigned char x, unsigned char y, char *s);
+void draw_bcd(unsigned char col, unsigned char row, unsigned char *n,
+              char *shown, unsigned char width);
+
+/* Pictures rather than text (the 3D view): a colour is the Mode 1
+ * byte for even pixel lines and the one for odd lines, so it can
+ * be a pattern, and the character that stands for it on the host */
+struct paint {
+    unsigned char even, odd;
+    char ch;
+};
+
+/* Paint pixel lines y0 to y1 - 1 of character column col, both
+ * bytes wide; y0 and y1 even, counted from the top of row 0.  The
+ * host shows a character cell in the colour of its middle lines. */
+void fill_span(unsigned char col, unsigned char y0, unsigned char y1,
+               const struct paint *p);
+
+/* "Are you sure? (Y/N)" on 1-based row; 1 for Y */
+unsigned char confirm(unsigned char row);
+
+#endif
@@ -0,0 +1,326 @@
+/*
+ * screen_cpc.c - the platform layer on the CPC
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * Glyphs go straight into Mode 1 screen memory and the map
+ * scrolls with the CRTC; keys come from the firmware through
+ * fgetc_cons().
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <arch/cpc/cpc.h>
+#include "screen.h"
+
+#define SCR_BASE   0xC000u
+
+/* ============================================================
+ * SCREEN HELPERS
+ * cls() still goes through the ANSI library for the text-only
+ * title and end screens.  In-game drawing bypasses it and writes
+ * glyphs straight into Mode 1 screen memory (see TEXT ENGINE).
+ * ============================================================ */
+
+/* Set the CRTC display start: R12/R13 take the offset in words
+ * (0-1023) into the 16K screen, with 0x30 in R12 selecting the
+ * screen at 0xC000.  Fastcall, so the offset arrives in HL. */
+void crtc_set_start(unsigned int words) __z88dk_fastcall __naked
+{
+#asm
+    ld   bc, $BC0C      ; select R12
+    out  (c), c
+    ld   a, h
+    and  3
+    or   $30
+    inc  b              ; $BD - write the selected register
+    out  (c), a
+    dec  b
+    inc  c              ; select R13
+    out  (c), c
+    inc  b
+    out  (c), l
+    ret
+#endasm
+}
+
+/* stdio draws as if the display started at 0xC000, and so do
+ * put_glyph()'s callers after it */
+void cls(void)
+{
+    scr_set_offset(0);
+#ifdef TEXT_FIRMWARE
+    putchar(12);        /* the firmware VDU's clear screen */
+#else
+    putchar(27); putchar('['); putchar('2'); putchar('J');
+    putchar(27); putchar('['); putchar('H');
+#endif
+}
+
+#if defined(REAL_TIME) || defined(SOUND)
+/* ============================================================
+ * FRAME FLYBACK
+ * The firmware calls the routine after the event block at
+ * FLY_HOOK at the start of every frame, with interrupts off.  It
+ * counts the frame for the game clock and plays that frame of
+ * sound.  The lower ROM is paged in over 0-0x3FFF then, where
+ * our code and the count may be, so the routine pages it out
+ * first.
+ * ============================================================ */
+
+unsigned int fly_frames;
+
+void fly_init(void) __naked
+{
+#asm
+    ld   hl, fly_hook
+    ld   de, $A669          ; FLY_HOOK + 9
+    ld   bc, fly_hook_end-fly_hook
+    ldir
+    ld   hl, $A660          ; FLY_HOOK
+    ld   b, $C1             ; express asynchronous, near address
+    ld   c, 0
+    ld   de, $A669
+    jp   $BCD7              ; KL NEW FRAME FLY
+
+fly_hook:
+    call $B909              ; KL L ROM DISABLE
+    push af
+    ld   hl, (_fly_frames)
+    inc  hl
+    ld   (_fly_frames), hl
+#ifdef SOUND
+    call _snd_frame
+#endif
+    pop  af
+    jp   $B90C              ; KL ROM RESTORE
+fly_hook_end:
+#endasm
+}
+
+void fly_done(void) __naked
+{
+#asm
+    ld   hl, $A660          ; FLY_HOOK
+    jp   $BCDD              ; KL DEL FRAME FLY
+#endasm
+}
+#endif
+
+#ifdef REAL_TIME
+/* ============================================================
+ * GAME CLOCK
+ * The frames counted by the flyback hook.  One load reads the
+ * count whole, wherever the interrupt falls.
+ * ============================================================ */
+
+unsigned int frame_count(void) __naked
+{
+#asm
+    ld   hl, (_fly_frames)
+    ret
+#endasm
+}
+
+/* KM READ CHAR: carry and the key in A if one is waiting */
+int key_scan(void) __naked
+{
+#asm
+    call $BB09
+    ld   hl, 0
+    ret  nc
+    ld   l, a
+    ret
+#endasm
+}
+#endif
+
+/* ============================================================
+ * TEXT ENGINE - direct-to-screen 8x8 glyphs
+ *
+ * Mode 1 is 40x25 characters, 2 bytes per character per line.
+ * Char row r, line l starts at 0xC000 + l*0x800 + r*80, so each
+ * glyph is 8 pairs of bytes 0x800 apart.  Pixel order within a
+ * byte is bit 7 (left) to bit 4 for pen bit 0, so pen 1 on paper
+ * 0 is simply the font nibble in the top half of each byte.
+ *
+ * When the map scrolls the CRTC start address moves instead, so
+ * every row starts scr_offset bytes further into its 2K block and
+ * wraps round at the end of it.  Glyphs sit on even offsets and
+ * never straddle the wrap, so masking each glyph's offset with
+ * 0x7FF is all the text engine has to do about it.
+ *
+ * Replaces ~9 putchar()s of ANSI parsing per cell with one table
+ * lookup and 16 byte stores.
+ * ============================================================ */
+
+/* 8x8 font for ASCII 32-127, bit 7 = leftmost pixel */
+static const unsigned char font[96 * 8] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /* space */
+    0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00,  /* '!' */
+    0x6C, 0x6C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /* '"' */
+    0x6C, 0x6C, 0xFE, 0x6C, 0xFE, 0x6C, 0x6C, 0x00,  /* '#' */
+    0x30, 0x7C, 0xC0, 0x78, 0x0C, 0xF8, 0x30, 0x00,  /* '$' */
+    0x00, 0xC6, 0xCC, 0x18, 0x30, 0x66, 0xC6, 0x00,  /* '%' */
+    0x38, 0x6C, 0x38, 0x76, 0xDC, 0xCC, 0x76, 0x00,  /* '&' */
+    0x60, 0x60, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00,  /* ''' */
+    0x18, 0x30, 0x60, 0x60, 0x60, 0x30, 0x18, 0x00,  /* '(' */
+    0x60, 0x30, 0x18, 0x18, 0x18, 0x30, 0x60, 0x00,  /* ')' */
+    0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00,  /* '*' */
+    0x00, 0x30, 0x30, 0xFC, 0x30, 0x30, 0x00, 0x00,  /* '+' */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x60,  /* ',' */
+    0x00, 0x00, 0x00, 0xFC, 0x00, 0x00, 0x00, 0x00,  /* '-' */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x00,  /* '.' */
+    0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0, 0x80, 0x00,  /* '/' */
+    0x7C, 0xC6, 0xCE, 0xDE, 0xF6, 0xE6, 0x7C, 0x00,  /* '0' */
+    0x30, 0x70, 0x30, 0x30, 0x30, 0x30, 0xFC, 0x00,  /* '1' */
+    0x78, 0xCC, 0x0C, 0x38, 0x60, 0xCC, 0xFC, 0x00,  /* '2' */
+    0x78, 0xCC, 0x0C, 0x38, 0x0C, 0xCC, 0x78, 0x00,  /* '3' */
+    0x1C, 0x3C, 0x6C, 0xCC, 0xFE, 0x0C, 0x1E, 0x00,  /* '4' */
+    0xFC, 0xC0, 0xF8, 0x0C, 0x0C, 0xCC, 0x78, 0x00,  /* '5' */
+    0x38, 0x60, 0xC0, 0xF8, 0xCC, 0xCC, 0x78, 0x00,  /* '6' */
+    0xFC, 0xCC, 0x0C, 0x18, 0x30, 0x30, 0x30, 0x00,  /* '7' */
+    0x78, 0xCC, 0xCC, 0x78, 0xCC, 0xCC, 0x78, 0x00,  /* '8' */
+    0x78, 0xCC, 0xCC, 0x7C, 0x0C, 0x18, 0x70, 0x00,  /* '9' */
+    0x00, 0x30, 0x30, 0x00, 0x00, 0x30, 0x30, 0x00,  /* ':' */
+    0x00, 0x30, 0x30, 0x00, 0x00, 0x30, 0x30, 0x60,  /* ';' */
+    0x18, 0x30, 0x60, 0xC0, 0x60, 0x30, 0x18, 0x00,  /* '<' */
+    0x00, 0x00, 0xFC, 0x00, 0x00, 0xFC, 0x00, 0x00,  /* '=' */
+    0x60, 0x30, 0x18, 0x0C, 0x18, 0x30, 0x60, 0x00,  /* '>' */
+    0x78, 0xCC, 0x0C, 0x18, 0x30, 0x00, 0x30, 0x00,  /* '?' */
+    0x7C, 0xC6, 0xDE, 0xDE, 0xDE, 0xC0, 0x78, 0x00,  /* '@' */
+    0x30, 0x78, 0xCC, 0xCC, 0xFC, 0xCC, 0xCC, 0x00,  /* 'A' */
+    0xFC, 0x66, 0x66, 0x7C, 0x66, 0x66, 0xFC, 0x00,  /* 'B' */
+    0x3C, 0x66, 0xC0, 0xC0, 0xC0, 0x66, 0x3C, 0x00,  /* 'C' */
+    0xF8, 0x6C, 0x66, 0x66, 0x66, 0x6C, 0xF8, 0x00,  /* 'D' */
+    0xFE, 0x62, 0x68, 0x78, 0x68, 0x62, 0xFE, 0x00,  /* 'E' */
+    0xFE, 0x62, 0x68, 0x78, 0x68, 0x60, 0xF0, 0x00,  /* 'F' */
+    0x3C, 0x66, 0xC0, 0xC0, 0xCE, 0x66, 0x3E, 0x00,  /* 'G' */
+    0xCC, 0xCC, 0xCC, 0xFC, 0xCC, 0xCC, 0xCC, 0x00,  /* 'H' */
+    0x78, 0x30, 0x30, 0x30, 0x30, 0x30, 0x78, 0x00,  /* 'I' */
+    0x1E, 0x0C, 0x0C, 0x0C, 0xCC, 0xCC, 0x78, 0x00,  /* 'J' */
+    0xE6, 0x66, 0x6C, 0x78, 0x6C, 0x66, 0xE6, 0x00,  /* 'K' */
+    0xF0, 0x60, 0x60, 0x60, 0x62, 0x66, 0xFE, 0x00,  /* 'L' */
+    0xC6, 0xEE, 0xFE, 0xFE, 0xD6, 0xC6, 0xC6, 0x00,  /* 'M' */
+    0xC6, 0xE6, 0xF6, 0xDE, 0xCE, 0xC6, 0xC6, 0x00,  /* 'N' */
+    0x38, 0x6C, 0xC6, 0xC6, 0xC6, 0x6C, 0x38, 0x00,  /* 'O' */
+    0xFC, 0x66, 0x66, 0x7C, 0x60, 0x60, 0xF0, 0x00,  /* 'P' */
+    0x78, 0xCC, 0xCC, 0xCC, 0xDC, 0x78, 0x1C, 0x00,  /* 'Q' */
+    0xFC, 0x66, 0x66, 0x7C, 0x6C, 0x66, 0xE6, 0x00,  /* 'R' */
+    0x78, 0xCC, 0xE0, 0x70, 0x1C, 0xCC, 0x78, 0x00,  /* 'S' */
+    0xFC, 0xB4, 0x30, 0x30, 0x30, 0x30, 0x78, 0x00,  /* 'T' */
+    0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xFC, 0x00,  /* 'U' */
+    0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0x78, 0x30, 0x00,  /* 'V' */
+    0xC6, 0xC6, 0xC6, 0xD6, 0xFE, 0xEE, 0xC6, 0x00,  /* 'W' */
+    0xC6, 0xC6, 0x6C, 0x38, 0x38, 0x6C, 0xC6, 0x00,  /* 'X' */
+    0xCC, 0xCC, 0xCC, 0x78, 0x30, 0x30, 0x78, 0x00,  /* 'Y' */
+    0xFE, 0xC6, 0x8C, 0x18, 0x32, 0x66, 0xFE, 0x00,  /* 'Z' */
+    0x78, 0x60, 0x60, 0x60, 0x60, 0x60, 0x78, 0x00,  /* '[' */
+    0xC0, 0x60, 0x30, 0x18, 0x0C, 0x06, 0x02, 0x00,  /* '\' */
+    0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0x78, 0x00,  /* ']' */
+    0x10, 0x38, 0x6C, 0xC6, 0x00, 0x00, 0x00, 0x00,  /* '^' */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF,  /* '_' */
+    0x30, 0x30, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00,  /* '`' */
+    0x00, 0x00, 0x78, 0x0C, 0x7C, 0xCC, 0x76, 0x00,  /* 'a' */
+    0xE0, 0x60, 0x60, 0x7C, 0x66, 0x66, 0xDC, 0x00,  /* 'b' */
+    0x00, 0x00, 0x78, 0xCC, 0xC0, 0xCC, 0x78, 0x00,  /* 'c' */
+    0x1C, 0x0C, 0x0C, 0x7C, 0xCC, 0xCC, 0x76, 0x00,  /* 'd' */
+    0x00, 0x00, 0x78, 0xCC, 0xFC, 0xC0, 0x78, 0x00,  /* 'e' */
+    0x38, 0x6C, 0x60, 0xF0, 0x60, 0x60, 0xF0, 0x00,  /* 'f' */
+    0x00, 0x00, 0x76, 0xCC, 0xCC, 0x7C, 0x0C, 0xF8,  /* 'g' */
+    0xE0, 0x60, 0x6C, 0x76, 0x66, 0x66, 0xE6, 0x00,  /* 'h' */
+    0x30, 0x00, 0x70, 0x30, 0x30, 0x30, 0x78, 0x00,  /* 'i' */
+    0x0C, 0x00, 0x0C, 0x0C, 0x0C, 0xCC, 0xCC, 0x78,  /* 'j' */
+    0xE0, 0x60, 0x66, 0x6C, 0x78, 0x6C, 0xE6, 0x00,  /* 'k' */
+    0x70, 0x30, 0x30, 0x30, 0x30, 0x30, 0x78, 0x00,  /* 'l' */
+    0x00, 0x00, 0xCC, 0xFE, 0xFE, 0xD6, 0xC6, 0x00,  /* 'm' */
+    0x00, 0x00, 0xF8, 0xCC, 0xCC, 0xCC, 0xCC, 0x00,  /* 'n' */
+    0x00, 0x00, 0x78, 0xCC, 0xCC, 0xCC, 0x78, 0x00,  /* 'o' */
+    0x00, 0x00, 0xDC, 0x66, 0x66, 0x7C, 0x60, 0xF0,  /* 'p' */
+    0x00, 0x00, 0x76, 0xCC, 0xCC, 0x7C, 0x0C, 0x1E,  /* 'q' */
+    0x00, 0x00, 0xDC, 0x76, 0x66, 0x60, 0xF0, 0x00,  /* 'r' */
+    0x00, 0x00, 0x7C, 0xC0, 0x78, 0x0C, 0xF8, 0x00,  /* 's' */
+    0x10, 0x30, 0x7C, 0x30, 0x30, 0x34, 0x18, 0x00,  /* 't' */
+    0x00, 0x00, 0xCC, 0xCC, 0xCC, 0xCC, 0x76, 0x00,  /* 'u' */
+    0x00, 0x00, 0xCC, 0xCC, 0xCC, 0x78, 0x30, 0x00,  /* 'v' */
+    0x00, 0x00, 0xC6, 0xD6, 0xFE, 0xFE, 0x6C, 0x00,  /* 'w' */
+    0x00, 0x00, 0xC6, 0x6C, 0x38, 0x6C, 0xC6, 0x00,  /* 'x' */
+    0x00, 0x00, 0xCC, 0xCC, 0xCC, 0x7C, 0x0C, 0xF8,  /* 'y' */
+    0x00, 0x00, 0xFC, 0x98, 0x30, 0x64, 0xFC, 0x00,  /* 'z' */
+    0x1C, 0x30, 0x30, 0xE0, 0x30, 0x30, 0x1C, 0x00,  /* '{' */
+    0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00,  /* '|' */
+    0xE0, 0x30, 0x30, 0x1C, 0x30, 0x30, 0xE0, 0x00,  /* '}' */
+    0x76, 0xDC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /* '~' */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /* DEL */
+};
+
+/* Mode 1 via the firmware clears the screen; the display start
+ * goes back to 0xC000 so row_off[] matches it. */
+void scr_clear(void)
+{
+    cpc_SetModo(1);
+    scr_set_offset(0);
+}
+
+/* Zero len bytes from offset off on all 8 pixel lines, wrapping
+ * round each 2K block */
+void scr_blank(unsigned int off, unsigned int len)
+{
+    unsigned char *line;
+    unsigned int n;
+    unsigned char l;
+
+    off &= SCR_LINE - 1;
+    n = SCR_LINE - off;
+    if (n > len) n = len;
+    line = (unsigned char *)SCR_BASE;
+    for (l = 0; l < 8; l++) {
+        memset(line + off, 0, n);
+        if (n < len) memset(line, 0, len - n);
+        line += SCR_LINE;
+    }
+}
+
+/* Draw one glyph at character column col, row row (0-based) */
+void put_glyph(unsigned char col, unsigned char row, unsigned char ch)
+{
+    unsigned char *scr;
+    const unsigned char *g;
+    unsigned char i, b;
+
+    if (ch < 32 || ch > 127) ch = '?';
+    scr = (unsigned char *)(SCR_BASE +
+          ((row_off[row] + (col << 1)) & (SCR_LINE - 1)));
+    g = font + ((unsigned int)(ch - 32) << 3);
+    for (i = 0; i < 8; i++) {
+        b = *g++;
+        scr[0] = b & 0xF0;
+        scr[1] = b << 4;
+        scr += SCR_LINE;
+    }
+}
+
+#ifdef VIEW_3D
+/* Two lines at a time, so a pass never leaves its character row */
+void fill_span(unsigned char col, unsigned char y0, unsigned char y1,
+               const struct paint *p)
+{
+    unsigned char *scr;
+    unsigned char e, o, l;
+
+    e = p->even; o = p->odd;
+    while (y0 < y1) {
+        l = y0 & 7;
+        scr = (unsigned char *)(SCR_BASE + ((unsigned int)l << 11) +
+              ((row_off[y0 >> 3] + (col << 1)) & (SCR_LINE - 1)));
+        for (; l < 8 && y0 < y1; l += 2, y0 += 2) {
+            scr[0] = e; scr[1] = e;
+            scr += SCR_LINE;
+            scr[0] = o; scr[1] = o;
+            scr += SCR_LINE;
+        }
+    }
+}
+#endif
@@ -0,0 +1,179 @@
+/*
+ * screen_host.c - the platform layer on a PC (gcc -DHOST)
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * The 40x25 grid is held as the CPC holds it - one character for
+ * each 2-byte cell of a 2K block that wraps - and read from the
+ * display start the way the CRTC would, so scrolling is the real
+ * code path.  Keys come from stdin:
+ *
+ *   ./maze_host              play in the terminal
+ *   ./maze_host < keys.txt   headless, for simulation, fuzzing
+ *                            and profiling; MAZE_SHOW=1 prints
+ *                            the screen at every key
+ *
+ * When stdin runs out it answers Q and Y until the game quits.
+ * In a REAL_TIME build the clock runs at 50 frames a second in a
+ * terminal; headless, each key in the file is one game tick (0
+ * for none) and the clock doesn't wait.
+ */
+
+#ifndef HOST
+#error screen_host.c is the PC platform layer - build with -DHOST
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <termios.h>
+#ifdef REAL_TIME
+#include <sys/select.h>
+#include <time.h>
+#endif
+#include "screen.h"
+
+#define SHOW_NONE  0
+#define SHOW_TERM  1    /* redraw in place with ANSI codes */
+#define SHOW_LOG   2    /* print each screen below the last */
+
+static unsigned char grid[SCR_LINE / 2];   /* 0 = never drawn */
+static unsigned int disp_start;            /* bytes, as the CRTC */
+static unsigned char glyph_mode;           /* scr_clear() since cls() */
+static unsigned char show, started, out_of_keys, quit_next;
+static struct termios tty_saved;
+
+static void tty_restore(void)
+{
+    tcsetattr(0, TCSANOW, &tty_saved);
+}
+
+/* Keys one at a time without echo when stdin is a terminal */
+static void host_start(void)
+{
+    struct termios t;
+
+    started = 1;
+    if (isatty(0) && tcgetattr(0, &tty_saved) == 0) {
+        t = tty_saved;
+        t.c_lflag &= ~(ICANON | ECHO);
+        tcsetattr(0, TCSANOW, &t);
+        atexit(tty_restore);
+        show = SHOW_TERM;
+    } else if (getenv("MAZE_SHOW")) {
+        show = SHOW_LOG;
+    }
+}
+
+static void show_grid(void)
+{
+    unsigned char r, c, ch;
+
+    if (show == SHOW_TERM) fputs("\033[H", stdout);
+    for (r = 0; r < SCR_ROWS; r++) {
+        for (c = 0; c < SCR_COLS; c++) {
+            ch = grid[((disp_start + r * 80 + (c << 1)) & (SCR_LINE - 1)) >> 1];
+            putchar(ch ? ch : ' ');
+        }
+        putchar('\n');
+    }
+    if (show == SHOW_LOG) puts("----------------------------------------");
+}
+
+void crtc_set_start(unsigned int words)
+{
+    disp_start = words << 1;
+}
+
+void cls(void)
+{
+    if (!started) host_start();
+    scr_set_offset(0);
+    glyph_mode = 0;
+    if (show == SHOW_TERM) fputs("\033[2J\033[H", stdout);
+}
+
+void scr_clear(void)
+{
+    if (!started) host_start();
+    memset(grid, 0, sizeof(grid));
+    glyph_mode = 1;
+    if (show == SHOW_TERM) fputs("\033[2J", stdout);
+    scr_set_offset(0);
+}
+
+void scr_blank(unsigned int off, unsigned int len)
+{
+    for (; len >= 2; len -= 2, off += 2)
+        grid[(off & (SCR_LINE - 1)) >> 1] = 0;
+}
+
+void put_glyph(unsigned char col, unsigned char row, unsigned char ch)
+{
+    if (ch < 32 || ch > 127) ch = '?';
+    grid[((row_off[row] + (col << 1)) & (SCR_LINE - 1)) >> 1] = ch;
+    /* Over a text screen (confirm() on the title) it goes straight
+     * to the terminal, as the ANSI library would put it */
+    if (!glyph_mode && show == SHOW_TERM)
+        printf("\033[%d;%dH%c", row + 1, col + 1, ch);
+}
+
+#ifdef VIEW_3D
+void fill_span(unsigned char col, unsigned char y0, unsigned char y1,
+               const struct paint *p)
+{
+    unsigned char row;
+
+    for (row = y0 >> 3; row << 3 < y1; row++)
+        if (y0 <= (row << 3) + 4 && (row << 3) + 4 < y1)
+            grid[((row_off[row] + (col << 1)) & (SCR_LINE - 1)) >> 1] = p->ch;
+}
+#endif
+
+int key_read(void)
+{
+    int c;
+
+    if (!started) host_start();
+    if (glyph_mode && show) show_grid();
+    fflush(stdout);
+    if (!out_of_keys) {
+        c = getchar();
+        if (c != EOF) return c;
+        out_of_keys = 1;
+    }
+    quit_next ^= 1;
+    return quit_next ? 'q' : 'y';
+}
+
+#ifdef REAL_TIME
+unsigned int frame_count(void)
+{
+    static unsigned int calls;
+    struct timespec t;
+
+    if (!started) host_start();
+    if (show != SHOW_TERM)
+        return ++calls;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 50 + t.tv_nsec / 20000000;
+}
+
+int key_scan(void)
+{
+    fd_set in;
+    struct timeval none = { 0, 0 };
+
+    if (!started) host_start();
+    if (show != SHOW_TERM)
+        return key_read();
+    if (glyph_mode) show_grid();
+    fflush(stdout);
+    FD_ZERO(&in);
+    FD_SET(0, &in);
+    if (select(1, &in, NULL, NULL, &none) <= 0) return 0;
+    return key_read();
+}
+#endif
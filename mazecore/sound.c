@@ -0,0 +1,396 @@
+/*
+ * sound.c - AY-3-8912 music and sound effects for the maze games
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * See sound.h.  The AY is behind the PPI: its register number or
+ * data goes out on PPI port A, and port C's top bits tell it what
+ * to do with it (0xC0 select the register, 0x80 write it, 0x00
+ * inactive).  The AY's clock is 1MHz, so a tone of f Hz has a
+ * period of 62500 / f.
+ */
+
+#include "sound.h"
+
+#if defined(SOUND) && !defined(HOST)
+
+/* ============================================================
+ * TUNE AND EFFECTS
+ * ============================================================ */
+
+/* Tone periods of the notes, C in octave 1 to B in octave 7 */
+const unsigned int snd_period[7 * 12] = {
+    1911, 1804, 1703, 1607, 1517, 1432, 1351, 1276, 1204, 1136, 1073, 1012,
+    956, 902, 851, 804, 758, 716, 676, 638, 602, 568, 536, 506,
+    478, 451, 426, 402, 379, 358, 338, 319, 301, 284, 268, 253,
+    239, 225, 213, 201, 190, 179, 169, 159, 150, 142, 134, 127,
+    119, 113, 106, 100, 95, 89, 84, 80, 75, 71, 67, 63,
+    60, 56, 53, 50, 47, 45, 42, 40, 38, 36, 34, 32,
+    30, 28, 27, 25, 24, 22, 21, 20, 19, 18, 17, 16
+};
+
+#define TONE(p)  ((p) & 0xFF), ((p) >> 8)
+
+static const unsigned char sfx_gem[] = {
+    TONE(60), 0, 14,   TONE(60), 0, 14,     /* C6 */
+    TONE(47), 0, 14,   TONE(47), 0, 14,     /* E6 */
+    TONE(40), 0, 13,   TONE(40), 0, 13,     /* G6 */
+    TONE(30), 0, 13,   TONE(30), 0, 12,     /* C7 */
+    TONE(30), 0, 10,   TONE(30), 0, 8,
+    TONE(30), 0, 6,    0
+};
+
+static const unsigned char sfx_hedge[] = {
+    TONE(0), 6, 13,    TONE(0), 10, 12,     /* a rustle of noise */
+    TONE(0), 14, 12,   TONE(0), 8, 11,
+    TONE(0), 18, 10,   TONE(0), 12, 9,
+    TONE(0), 20, 8,    TONE(0), 16, 6,
+    TONE(0), 24, 4,    0
+};
+
+static const unsigned char sfx_ghost[] = {
+    TONE(300), 31, 15,  TONE(360), 31, 15,  /* falling, and rough */
+    TONE(420), 28, 14,  TONE(480), 26, 14,
+    TONE(560), 24, 13,  TONE(640), 22, 12,
+    TONE(720), 20, 11,  TONE(800), 18, 10,
+    TONE(900), 16, 8,   TONE(1000), 14, 6,
+    TONE(1100), 12, 4,  0
+};
+
+static const unsigned char sfx_level[] = {
+    TONE(119), 0, 14,  TONE(119), 0, 14,    /* C5 */
+    TONE(119), 0, 14,  TONE(119), 0, 12,
+    TONE(95), 0, 14,   TONE(95), 0, 14,     /* E5 */
+    TONE(95), 0, 14,   TONE(95), 0, 12,
+    TONE(80), 0, 14,   TONE(80), 0, 14,     /* G5 */
+    TONE(80), 0, 14,   TONE(80), 0, 12,
+    TONE(60), 0, 15,   TONE(60), 0, 15,     /* C6, held */
+    TONE(60), 0, 14,   TONE(60), 0, 14,
+    TONE(60), 0, 13,   TONE(60), 0, 13,
+    TONE(60), 0, 12,   TONE(60), 0, 11,
+    TONE(60), 0, 10,   TONE(60), 0, 8,
+    TONE(60), 0, 6,    TONE(60), 0, 4,
+    0
+};
+
+/* By SFX_ number, from 1 */
+const unsigned char *sfx_table[4] = {
+    sfx_gem, sfx_hedge, sfx_ghost, sfx_level
+};
+
+#define A2  SND_NOTE(2, 9)
+#define E2  SND_NOTE(2, 4)
+#define F2  SND_NOTE(2, 5)
+#define G2  SND_NOTE(2, 7)
+#define F4  SND_NOTE(4, 5)
+#define G4s SND_NOTE(4, 8)
+#define A4  SND_NOTE(4, 9)
+#define B4  SND_NOTE(4, 11)
+#define C5  SND_NOTE(5, 0)
+#define D5  SND_NOTE(5, 2)
+#define E5  SND_NOTE(5, 4)
+#define F5  SND_NOTE(5, 5)
+#define G5  SND_NOTE(5, 7)
+#define A5  SND_NOTE(5, 9)
+#define OFF SND_OFF
+
+/* A minor, round and round: patterns 0 1 0 2 */
+static const unsigned char maze_patterns[3 * SND_ROWS * 2] = {
+    A4, A2,  0, 0,  C5, 0,  0, 0,  E5, A2,  0, 0,  A5, 0,  0, 0,
+    G5, E2,  0, 0,  E5, 0,  0, 0,  C5, E2,  0, 0,  D5, 0,  0, 0,
+
+    F4, F2,  0, 0,  A4, 0,  0, 0,  C5, F2,  0, 0,  F5, 0,  0, 0,
+    E5, G2,  0, 0,  C5, 0,  0, 0,  A4, G2,  0, 0,  B4, 0,  0, 0,
+
+    E5, E2,  0, 0,  D5, 0,  0, 0,  C5, E2,  0, 0,  B4, 0,  0, 0,
+    C5, E2,  0, 0,  B4, 0,  0, 0,  G4s, E2, 0, 0,  0, 0,  OFF, OFF
+};
+
+static const unsigned char maze_order[] = { 0, 1, 0, 2, SND_END };
+
+const struct tune tune_maze = { 8, maze_order, maze_patterns };
+
+/* ============================================================
+ * PLAYER
+ * The game only sets snd_next/snd_start and snd_req; the rest is
+ * the interrupt's.  snd_regs is the AY's registers 0-10: tone
+ * periods A, B and C, noise period, mixer, volumes A, B and C.
+ * The mixer always leaves bit 6 clear, which keeps the AY's I/O
+ * port an input for the keyboard scan.
+ * ============================================================ */
+
+unsigned char snd_regs[11];
+const struct tune *snd_next;    /* tune asked for ... */
+unsigned char snd_start;        /* ... when this is set */
+unsigned char snd_req;          /* effect asked for, 0 for none */
+
+const struct tune *snd_tune;    /* playing, 0 for none */
+const unsigned char *snd_order; /* next pattern number */
+const unsigned char *snd_row;   /* next row */
+unsigned char snd_rows;         /* rows left in the pattern */
+unsigned char snd_wait;         /* frames to the next row */
+unsigned char snd_prio;         /* effect playing, 0 for none */
+const unsigned char *snd_fx;    /* its next step */
+
+void snd_music(const struct tune *t)
+{
+    snd_next = t;
+    snd_start = 1;
+}
+
+void snd_sfx(unsigned char n)
+{
+    snd_req = n;
+}
+
+/* One frame of sound; from the frame flyback interrupt, and
+ * uses AF, BC, DE and HL only.  T-states in sound.h. */
+void snd_frame(void) __naked
+{
+#asm
+    ld   a, (_snd_start)    ; a new tune?
+    or   a
+    jr   z, sf_req
+    xor  a
+    ld   (_snd_start), a
+    ld   (_snd_regs+8), a   ; A and B quiet until their first notes
+    ld   (_snd_regs+9), a
+    ld   (_snd_rows), a     ; so the first row starts a pattern
+    inc  a
+    ld   (_snd_wait), a
+    ld   hl, (_snd_next)
+    ld   (_snd_tune), hl
+    ld   a, h
+    or   l
+    jr   z, sf_req
+    inc  hl
+    ld   e, (hl)
+    inc  hl
+    ld   d, (hl)
+    ld   (_snd_order), de
+
+sf_req:
+    ld   a, (_snd_req)      ; an effect asked for?
+    or   a
+    jr   z, sf_step
+    ld   c, a
+    xor  a
+    ld   (_snd_req), a
+    ld   a, (_snd_prio)
+    cp   c
+    jr   z, sf_take         ; the same one starts again
+    jr   nc, sf_step        ; something more important is playing
+sf_take:
+    ld   a, c
+    ld   (_snd_prio), a
+    add  a, a
+    ld   e, a
+    ld   d, 0
+    ld   hl, _sfx_table-2
+    add  hl, de
+    ld   a, (hl)
+    inc  hl
+    ld   h, (hl)
+    ld   l, a
+    ld   (_snd_fx), hl
+
+sf_step:
+    ld   b, $3C             ; mixer: tone on A and B only
+    ld   a, (_snd_prio)
+    or   a
+    jr   z, sf_quiet
+    ld   hl, (_snd_fx)      ; the step of the effect for this frame
+    ld   e, (hl)
+    inc  hl
+    ld   d, (hl)
+    inc  hl
+    ld   c, (hl)
+    inc  hl
+    ld   a, (hl)
+    inc  hl
+    or   a
+    jr   z, sf_end
+    ld   (_snd_fx), hl
+    ld   (_snd_regs+10), a
+    ld   (_snd_regs+4), de
+    ld   a, d
+    or   e
+    jr   z, sf_notone
+    res  2, b               ; tone on C
+sf_notone:
+    ld   a, c
+    or   a
+    jr   z, sf_mix
+    ld   (_snd_regs+6), a
+    res  5, b               ; noise on C
+    jr   sf_mix
+sf_end:
+    xor  a
+    ld   (_snd_prio), a
+sf_quiet:
+    xor  a
+    ld   (_snd_regs+10), a
+sf_mix:
+    ld   a, b
+    ld   (_snd_regs+7), a
+
+    ld   hl, (_snd_tune)    ; the tune, on A and B
+    ld   a, h
+    or   l
+    jp   z, sf_out
+    ld   hl, _snd_wait
+    dec  (hl)
+    jp   nz, sf_fade
+    ld   de, (_snd_tune)
+    ld   a, (de)            ; speed
+    ld   (hl), a
+    ld   a, (_snd_rows)
+    or   a
+    jr   nz, sf_row
+    ld   hl, (_snd_order)   ; next pattern
+    ld   a, (hl)
+    cp   $FF                ; SND_END: back to the start
+    jr   nz, sf_pat
+    ex   de, hl
+    inc  hl
+    ld   a, (hl)
+    inc  hl
+    ld   h, (hl)
+    ld   l, a
+    ld   a, (hl)
+sf_pat:
+    inc  hl
+    ld   (_snd_order), hl
+    ld   l, a
+    ld   h, 0
+    add  hl, hl             ; * SND_ROWS * 2
+    add  hl, hl
+    add  hl, hl
+    add  hl, hl
+    add  hl, hl
+    ex   de, hl
+    ld   hl, (_snd_tune)
+    inc  hl
+    inc  hl
+    inc  hl
+    ld   a, (hl)
+    inc  hl
+    ld   h, (hl)
+    ld   l, a
+    add  hl, de
+    ld   (_snd_row), hl
+    ld   a, 16              ; SND_ROWS
+    ld   (_snd_rows), a
+sf_row:
+    ld   hl, _snd_rows
+    dec  (hl)
+    ld   hl, (_snd_row)
+    ld   a, (hl)
+    inc  hl
+    ld   c, (hl)
+    inc  hl
+    ld   (_snd_row), hl
+    push bc
+    ld   hl, _snd_regs
+    ld   de, _snd_regs+8
+    call sf_note
+    pop  bc
+    ld   a, c
+    ld   hl, _snd_regs+2
+    ld   de, _snd_regs+9
+    call sf_note
+    jr   sf_out
+
+sf_fade:
+    ld   hl, _snd_regs+8    ; notes fade from 13 to 8
+    call sf_fade1
+    inc  hl
+    call sf_fade1
+
+sf_out:
+    ld   hl, _snd_regs      ; the copy out to the AY
+    ld   de, $C080          ; PSG: select, write
+    ld   c, 0               ; PSG: inactive
+    xor  a
+sf_reg:
+    ld   b, $F4
+    out  (c), a             ; register number on PPI port A
+    ld   b, $F6
+    out  (c), d
+    out  (c), c
+    ld   b, $F5             ; outi drops it to $F4 first
+    outi                    ; the value on port A
+    ld   b, $F6
+    out  (c), e
+    out  (c), c
+    inc  a
+    cp   11
+    jr   c, sf_reg
+    ret
+
+; A = the byte of a row for a channel, HL = its period registers,
+; DE = its volume register
+sf_note:
+    or   a
+    ret  z
+    inc  a                  ; SND_OFF
+    jr   nz, sn_on
+    ld   (de), a
+    ret
+sn_on:
+    ex   de, hl
+    ld   (hl), 13
+    ex   de, hl
+    add  a, a               ; (note + 1) * 2
+    push hl
+    ld   c, a
+    ld   b, 0
+    ld   hl, _snd_period-4
+    add  hl, bc
+    ld   c, (hl)
+    inc  hl
+    ld   b, (hl)
+    pop  hl
+    ld   (hl), c
+    inc  hl
+    ld   (hl), b
+    ret
+
+sf_fade1:
+    ld   a, (hl)
+    cp   9
+    ret  c
+    dec  (hl)
+    ret
+#endasm
+}
+
+/* ============================================================
+ * START AND STOP
+ * ============================================================ */
+
+/* Silence all three channels now, with the interrupt held off.
+ * The hook (fly_init()) goes on calling snd_frame, which keeps
+ * them quiet until a tune or an effect is asked for. */
+void snd_done(void) __naked
+{
+#asm
+    di
+    xor  a
+    ld   (_snd_tune), a
+    ld   (_snd_tune+1), a
+    ld   (_snd_prio), a
+    ld   (_snd_req), a
+    ld   (_snd_start), a
+    ld   (_snd_regs+8), a
+    ld   (_snd_regs+9), a
+    ld   (_snd_regs+10), a
+    call sf_out
+    ei
+    ret
+#endasm
+}
+
+#endif
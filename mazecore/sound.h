@@ -0,0 +1,82 @@
+/*
+ * sound.h - AY-3-8912 music and sound effects for the maze games
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * Built with SOUND=ay (see options.mk).  The player runs in the
+ * frame flyback interrupt, 50 times a second, from the hook on
+ * the firmware's frame flyback event that also drives the game
+ * clock (screen.h).  The game only asks for a tune or an
+ * effect; everything that touches the chip happens in the
+ * interrupt, so it never has to share the PSG with the keyboard
+ * scan.
+ *
+ * Channels A and B play the tune, channel C the effects.  An
+ * effect starts only if nothing more important is playing: a
+ * higher SFX_ number wins, an equal one starts again.
+ *
+ * Cost per interrupt: all eleven tone, noise, mixer and volume
+ * registers are written every frame from a copy in RAM, and
+ * working out the copy is one tune row and one effect step at
+ * most, so a longer tune or more notes cost no more.  make
+ * sndticks in either game runs snd_frame under z88dk-ticks
+ * through the tune and every effect (tools/sndtime.c) and prints
+ * the fewest and most T-states a frame, each instruction rounded
+ * up to 4 for the CPC's wait states; set that most against the
+ * 79872 in a frame, all spent with interrupts off.
+ *
+ * Tune layout (struct tune):
+ *   speed     frames per row
+ *   order     pattern numbers to play, SND_END to go round again
+ *   patterns  SND_ROWS rows each, a byte for channel A then one
+ *             for channel B: 0 carries on, SND_OFF silences it,
+ *             otherwise a note (SND_NOTE, 1-84)
+ *
+ * A note starts at volume 13 and fades to 8.  Effect layout: a
+ * step of 4 bytes a frame - tone period (low, high; 0 for no
+ * tone), noise period (0 for none) and volume, 0 at the end.
+ */
+
+#ifndef SOUND_H
+#define SOUND_H
+
+/* Effects, least important first */
+#define SFX_GEM     1
+#define SFX_HEDGE   2
+#define SFX_GHOST   3
+#define SFX_LEVEL   4
+
+#define SND_ROWS    16
+#define SND_END     0xFF
+#define SND_OFF     0xFF
+/* Semitone 0 (C) to 11 (B) of octave 1-7; A in octave 4 is 440Hz */
+#define SND_NOTE(oct, semi)  (((oct) - 1) * 12 + (semi) + 1)
+
+struct tune {
+    unsigned char speed;
+    const unsigned char *order;
+    const unsigned char *patterns;
+};
+
+#if defined(SOUND) && !defined(HOST)
+extern const struct tune tune_maze;
+
+/* Stop the tune and any effect, and silence the chip */
+void snd_done(void);
+
+/* Play a tune from its start, over and over; 0 stops it */
+void snd_music(const struct tune *t);
+/* Play an effect, if nothing more important is playing */
+void snd_sfx(unsigned char n);
+
+/* One frame of the player, from the frame flyback interrupt */
+void snd_frame(void);
+#else
+#define snd_done()
+#define snd_music(t)
+#define snd_sfx(n)
+#endif
+
+#endif
@@ -0,0 +1,74 @@
+/*
+ * task.c - jobs run a unit at a time in the game's spare time
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * See task.h.
+ */
+
+#include "screen.h"
+#include "input.h"
+#include "task.h"
+
+static task_fn tasks[TASK_MAX];
+static unsigned char task_next;
+
+void task_start(task_fn f)
+{
+    unsigned char i, free;
+
+    free = TASK_MAX;
+    for (i = 0; i < TASK_MAX; i++) {
+        if (tasks[i] == f) return;
+        if (!tasks[i]) free = i;
+    }
+    if (free < TASK_MAX) tasks[free] = f;
+}
+
+void task_stop(task_fn f)
+{
+    unsigned char i;
+
+    for (i = 0; i < TASK_MAX; i++)
+        if (tasks[i] == f) tasks[i] = 0;
+}
+
+unsigned char task_run(void)
+{
+    unsigned char n;
+    task_fn f;
+
+    for (n = 0; n < TASK_MAX; n++) {
+        f = tasks[task_next];
+        if (++task_next == TASK_MAX) task_next = 0;
+        if (f) {
+            if (!f()) task_stop(f);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#ifdef REAL_TIME
+static unsigned int tick_at;    /* frame the last tick started on */
+
+/* A script runs without waiting, so it gets one unit of each
+ * task a tick */
+void tick_wait(void)
+{
+#ifdef KEY_SCRIPT
+    unsigned char n;
+
+    for (n = 0; n < TASK_MAX; n++)
+        task_run();
+#else
+    while ((unsigned int)(frame_count() - tick_at) < TICK_FRAMES)
+        task_run();
+    tick_at += TICK_FRAMES;
+    if ((unsigned int)(frame_count() - tick_at) >= TICK_FRAMES)
+        tick_at = frame_count();
+#endif
+}
+#endif
@@ -0,0 +1,51 @@
+/*
+ * task.h - jobs run a unit at a time in the game's spare time
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * With PACE=realtime most of each game tick is spent waiting for
+ * the next one.  tick_wait() spends the wait on tasks instead:
+ * jobs too long to do in one go without the game hitching, such
+ * as a distance field for a big maze or the next level's maze.
+ *
+ * A task is a function that does one unit of its job - a room
+ * of the backtracker or a row of Eller's carver, DF_UNIT cells of
+ * the ghosts' distance field - and returns 0 once there is
+ * nothing left, when it is dropped.  Tasks take turns a unit at a
+ * time for as long as the next tick isn't due, so the budget is
+ * the clock itself: the frames left before the tick, whatever a
+ * unit costs.  A tick can start late by one unit at most, which
+ * is why the units are small.  (Their cost isn't measured yet:
+ * make profile in either game lists carve_step and df_grow with
+ * the T-states they took and how often they ran.)
+ *
+ * Inside the tick itself the only job of this kind is the
+ * distance field's share for the turn, DF_TURN cells, the same
+ * 16 units the task does ahead of it when there is time.
+ *
+ * A task may only work ahead: the game must get the same result
+ * whether its units ran or not, or replays would differ.
+ */
+
+#ifndef TASK_H
+#define TASK_H
+
+#define TASK_MAX    4
+
+typedef unsigned char (*task_fn)(void);
+
+/* Add a task (once, however often it is started), or drop it */
+void task_start(task_fn f);
+void task_stop(task_fn f);
+
+/* One unit of the next task in turn; 0 if there are none */
+unsigned char task_run(void);
+
+#ifdef REAL_TIME
+/* Run tasks until the next game tick is due (see key_tick()) */
+void tick_wait(void);
+#endif
+
+#endif
@@ -0,0 +1,213 @@
+/*
+ * view3d.c - first-person view of the maze for the maze games
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * See view3d.h.  Only built with VIEW=3d.
+ */
+
+#ifdef VIEW_3D
+
+#include <string.h>
+#include "mazegen.h"
+#include "screen.h"
+#include "play.h"
+#include "view3d.h"
+
+#define R3_TOP      8               /* first line of the picture: row 1 */
+#define R3_LINES    (VIEW_H * 8)
+#define R3_HALF     (R3_LINES / 2)  /* the horizon */
+#define R3_RAYS     SCR_COLS        /* one per character column */
+#define R3_MARK_FAR 16              /* cells looked along for a marker */
+
+#if R3_LINES != 128
+#error view3d.c works its wall heights out for a 128-line picture
+#endif
+
+/* ============================================================
+ * COLOURS
+ * The game's four pens: 0 blue, 1 yellow, 2 cyan, 3 red.  Mode 1
+ * keeps pen bit 0 of pixels 0-3 in bits 7-4 and bit 1 in bits 3-0,
+ * so pen 1 is 0xF0 and pen 2 0x0F; the patterns put a pen on
+ * every other pixel, the other way round on the next line.
+ * ============================================================ */
+
+#define P_SKY    0
+#define P_FLOOR  1
+#define P_FACE   2      /* a hedge square on to the view */
+#define P_SIDE   3      /* a hedge along it */
+#define P_GEM    4
+#define P_EXIT   5
+#define P_GHOST  6
+#define P_NONE   0xFF   /* column not on screen */
+
+static const struct paint paints[] = {
+    { 0x00, 0x00, ' ' },    /* blue */
+    { 0xA0, 0x50, '.' },    /* yellow on blue */
+    { 0x0F, 0x0F, '#' },    /* cyan */
+    { 0x0A, 0x05, ':' },    /* cyan on blue */
+    { 0xF0, 0xF0, '*' },    /* yellow */
+    { 0xFA, 0xF5, 'E' },    /* red on yellow */
+    { 0xFF, 0xFF, 'G' }     /* red */
+};
+
+/* ============================================================
+ * RAYS
+ * A ray leaning 'lean'/256 of a cell to one side per cell ahead
+ * crosses its (2k - 1)th half-cell line ahead at (2k - 1) * lean,
+ * and its (2j - 1)th to the side at (2j - 1) * 256, in the same
+ * units - so the walk compares two sums and never divides, as
+ * raytest.c's does.  A hedge met k cells ahead is (k - 1/2) cells
+ * away and stands 128 / (k - 1/2) = 256 / (2k - 1) lines high; one
+ * met j cells to the side is 256 / lean further, so lean /
+ * (2j - 1) lines high.  One division a ray.
+ * ============================================================ */
+
+/* From the middle of the view outwards: a camera plane of 0.66,
+ * about 66 degrees across as in raytest.c, with each ray in the
+ * middle of its column so that none points straight ahead */
+static const unsigned char ray_lean[R3_RAYS / 2] = {
+      4,  13,  21,  30,  38,  46,  55,  63,  72,  80,
+     89,  97, 106, 114, 123, 131, 139, 148, 156, 165
+};
+
+/* What each column shows: its first wall line and the face */
+static unsigned char col_top[R3_RAYS];
+static unsigned char col_paint[R3_RAYS];
+
+/* What the picture was drawn for */
+static unsigned char r3_x, r3_y, r3_dir;
+static unsigned char r3_mark, r3_far;       /* 0, or P_ and cells */
+static unsigned char r3_lo, r3_hi;          /* columns it covers */
+static unsigned char r3_stale;
+
+static void span(unsigned char col, unsigned char y0, unsigned char y1,
+                 unsigned char p)
+{
+    fill_span(col, R3_TOP + y0, R3_TOP + y1, &paints[p]);
+}
+
+/* Sky, wall from top to its mirror below the horizon, floor; only
+ * the lines that change colour are painted */
+static void paint_col(unsigned char col, unsigned char top,
+                      unsigned char p)
+{
+    unsigned char old;
+
+    old = col_paint[col] == P_NONE ? 0 : col_top[col];
+    if (p != col_paint[col]) {
+        if (top < R3_HALF) span(col, top, R3_LINES - top, p);
+    } else if (top < old) {
+        span(col, top, old, p);
+        span(col, R3_LINES - old, R3_LINES - top, p);
+    }
+    if (top > old) {
+        span(col, old, top, P_SKY);
+        span(col, R3_LINES - top, R3_LINES - old, P_FLOOR);
+    }
+    col_top[col] = top;
+    col_paint[col] = p;
+}
+
+void view3d_reset(void)
+{
+    memset(col_paint, P_NONE, sizeof(col_paint));
+    r3_lo = r3_hi = 0;
+    r3_stale = 1;
+}
+
+void view3d_draw(void)
+{
+    unsigned char col, k, j, top, lean, p, mark, far, lo, hi;
+    unsigned char x, y;
+    unsigned int along, aside, h;
+    int ahead, side;            /* dcell[] offsets */
+    cell_t c;
+
+    /* The nearest gem, ghost or exit straight ahead */
+    x = px; y = py;
+    mark = 0;
+    for (far = 1; far <= R3_MARK_FAR; far++) {
+        x += dx[pdir]; y += dy[pdir];
+        c = CELL(x, y);
+        if (WALL_AT(c)) break;
+        if (occ[c]) mark = P_GHOST;
+        else if (gem_at(x, y)) mark = P_GEM;
+        else if (x == exit_x && y == exit_y) mark = P_EXIT;
+        if (mark) break;
+    }
+    if (!mark) far = 0;
+
+    if (!r3_stale && px == r3_x && py == r3_y && pdir == r3_dir &&
+        mark == r3_mark && far == r3_far)
+        return;
+
+    /* It is half a cell wide: 8 / far rays either side of the
+     * middle.  Columns under it, now or last time, are drawn whole. */
+    lo = hi = 0;
+    if (mark) {
+        k = 8 / far;
+        if (!k) k = 1;
+        lo = R3_RAYS / 2 - k;
+        hi = R3_RAYS / 2 + k;
+    }
+    for (col = r3_lo; col < r3_hi; col++) col_paint[col] = P_NONE;
+    for (col = lo; col < hi; col++) col_paint[col] = P_NONE;
+
+    ahead = dcell[pdir];
+    for (col = 0; col < R3_RAYS; col++) {
+        if (col < R3_RAYS / 2) {
+            lean = ray_lean[R3_RAYS / 2 - 1 - col];
+            side = dcell[(pdir + 3) & 3];
+        } else {
+            lean = ray_lean[col - R3_RAYS / 2];
+            side = dcell[(pdir + 1) & 3];
+        }
+
+        /* The border is all hedge, so every ray stops */
+        c = CELL(px, py);
+        along = lean; aside = 256;
+        k = j = 1;
+        while (1) {
+            if (along < aside) {
+                c += ahead;
+                if (WALL_AT(c)) { h = 256 / (2 * k - 1); p = P_FACE; break; }
+                k++;
+                along += lean << 1;
+            } else {
+                c += side;
+                if (WALL_AT(c)) { h = lean / (2 * j - 1); p = P_SIDE; break; }
+                j++;
+                aside += 512;
+            }
+        }
+        top = h >= R3_LINES ? 0 : (R3_HALF - (h >> 1)) & 0xFE;
+        paint_col(col, top, p);
+    }
+
+    /* The marker stands on the floor at the middle of its cell,
+     * where a hedge would be 128 / far lines high */
+    if (mark) {
+        h = R3_LINES / far;
+        y = (R3_HALF + (h >> 1)) & 0xFE;
+        if (mark == P_GEM)
+            top = R3_HALF + (h >> 2);       /* a quarter as high */
+        else if (mark == P_GHOST)
+            top = R3_HALF - (h >> 2);       /* three quarters */
+        else
+            top = R3_HALF - (h >> 1);       /* a doorway */
+        top &= 0xFE;
+        if (top >= y) top = y - 2;
+        for (col = lo; col < hi; col++)
+            span(col, top, y, mark);
+    }
+
+    r3_x = px; r3_y = py; r3_dir = pdir;
+    r3_mark = mark; r3_far = far;
+    r3_lo = lo; r3_hi = hi;
+    r3_stale = 0;
+}
+
+#endif
@@ -0,0 +1,42 @@
+/*
+ * view3d.h - first-person view of the maze for the maze games
+ * Amstrad CPC 6128 / z88dk
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * Built with VIEW=3d (see options.mk).  The DDA raycaster from
+ * testraycast/raytest.c, drawing over the map rows instead of the
+ * map: 40 rays, each a character column wide and two pixel lines
+ * a step, in the VIEW_H * 8 lines below row 0.  It reads the
+ * engine's own wall[], occ[] and gems, so a new maze, a parted
+ * hedge or a ghost's step needs nothing rebuilding - the next
+ * view3d_draw() just sees it.
+ *
+ * The player is always at a cell's centre facing along the grid,
+ * so each ray's slope is a constant and its walk is the same in
+ * every direction: steps along the view and steps to one side.
+ * The cells ahead down the line of sight are looked along too,
+ * and the nearest gem, ghost or exit there is drawn standing in
+ * the corridor.
+ *
+ * A redraw is skipped unless the player's cell or facing, or what
+ * stands ahead, has changed.  Each column then only paints the
+ * lines whose colour changed - a wall that grew or shrank, or
+ * turned from one face to the other - so a step usually paints a
+ * fraction of the picture.
+ */
+
+#ifndef VIEW3D_H
+#define VIEW3D_H
+
+#ifdef VIEW_3D
+/* The whole picture again at the next view3d_draw(), as after the
+ * screen was cleared or drawn over */
+void view3d_reset(void);
+
+/* Bring the picture up to date, if anything in it has changed */
+void view3d_draw(void);
+#endif
+
+#endif
@@ -94,6 +94,21 @@ static void draw_column(int x, int wall_top, int wall_bot)
 /* Block until a keypress; returns ASCII code. */
 extern int fgetc_cons(void);
 
+#ifdef PROFILE
+/* make profile: a fixed walk round the room stands in for the
+ * keyboard, and the first real key wait after it ends the run. */
+static const char walk[] = "qqqpqqqpqqaaooqqqpqqqqoooqqpppqq";
+static unsigned char walk_at;
+
+static int next_key(void)
+{
+    if (walk[walk_at]) return walk[walk_at++];
+    return fgetc_cons();
+}
+#else
+#define next_key fgetc_cons
+#endif
+
 
 /* Direction deltas: N=0, E=1, S=2, W=3.
  * Use int, not signed char — sccz80 may not sign-extend narrow types correctly. */
@@ -220,7 +235,7 @@ int main(void)
 
     for (;;) {
         moved = 0;
-        c = fgetc_cons();
+        c = next_key();
 
         switch (c) {
             case 'q': case 'Q':        /* move forward */
@@ -0,0 +1,219 @@
+/*
+ * dfcheck - check the ghosts' distance field against a full search
+ * Host tool, build with gcc (see tools/Makefile)
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * Plays mazes 1-255 with the games' own engine (mazecore/play.c):
+ * the player walks at random, now and then parting a hedge, and
+ * the ghosts move after every step as in the game.  After each
+ * turn the field is checked against a plain breadth-first search
+ * from the player:
+ *
+ *   - every cell with a distance has the right one, mod 256
+ *   - the search has reached every cell nearer than the furthest
+ *     it has reached, or every cell there is if it has finished
+ *
+ * which is all a ghost's neighbour lookup relies on.  A field the
+ * player has moved away from isn't checked until a ghost asks for
+ * it again, as it is started afresh then.
+ *
+ * It also prints the cells the search expanded a turn (df_work,
+ * what AI_COST=show puts on the screen; never more than DF_TURN),
+ * and how many cells' true distances each step of the player
+ * changed - the cells an incremental repair of the field would
+ * have had to rewrite.
+ *
+ * Built with -DREAL_TIME, each maze is played a second time with
+ * a few slices of the field's task run before every turn, as the
+ * game's spare time would, and the ghosts must go exactly where
+ * they went without them.
+ *
+ *   dfcheck           255 mazes, 400 steps each
+ *   dfcheck steps     ... or that many steps each
+ *
+ * Build it with the same -D options as the game; it exits 1 if
+ * any check failed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rng.h"
+#include "mazegen.h"
+#include "screen.h"
+#include "play.h"
+
+#define CELLS  (MAZE_W * MAZE_H)
+
+/* The engine's field (play.c) */
+extern unsigned char dist[CELLS];
+extern unsigned int df_seen[WALL_WORDS];
+extern unsigned int df_head, df_tail;
+extern unsigned char df_px, df_py;
+extern unsigned int df_work;
+void move_ghosts(unsigned char steps);
+#ifdef REAL_TIME
+unsigned char df_slice(void);
+#endif
+
+#define DF_SEEN(c) (df_seen[(c) >> 4] & cell_bit[(c) & 15])
+
+/* The game's part, not needed here */
+void draw_status(void) {}
+void draw_fields(void) {}
+
+static int ref[CELLS], last[CELLS];
+
+/* Plain breadth-first search from the player, -1 for no way */
+static void search(void)
+{
+    static cell_t queue[CELLS];
+    int head, tail, i;
+    cell_t c, n;
+
+    for (i = 0; i < CELLS; i++) ref[i] = -1;
+    c = CELL(px, py);
+    ref[c] = 0;
+    queue[0] = c;
+    head = 0; tail = 1;
+    while (head < tail) {
+        c = queue[head++];
+        for (i = 0; i < 4; i++) {
+            n = c + dcell[i];
+            if (ref[n] < 0 && !WALL_AT(n)) {
+                ref[n] = ref[c] + 1;
+                queue[tail++] = n;
+            }
+        }
+    }
+}
+
+/* The number of cells in the wrong state */
+static int check_field(void)
+{
+    int c, far, bad;
+
+    bad = 0;
+    far = 0;
+    for (c = 0; c < CELLS; c++) {
+        if (!DF_SEEN(c)) continue;
+        if (ref[c] < 0 || (ref[c] & 0xFF) != dist[c]) bad++;
+        else if (ref[c] > far) far = ref[c];
+    }
+    if (df_head == df_tail) far = 0x7FFF;    /* finished */
+    for (c = 0; c < CELLS; c++)
+        if (!DF_SEEN(c) && ref[c] >= 0 && ref[c] < far) bad++;
+    return bad;
+}
+
+static long turns, checked, wrong, work, changed, moves;
+static int most_work, most_seed, most_changed;
+
+/* Play maze 'seed' for 'steps' steps, with up to 'slices' slices
+ * of the field's task before each turn; returns a sum of where
+ * the ghosts went */
+static unsigned long play(int seed, int steps, int slices)
+{
+    unsigned long sum, lcg;
+    int s, c, d, k;
+    unsigned char nx, ny;
+
+    rng_layout_seed(seed);
+    maze_seed = seed;
+    rng_play_state = rng_layout_state;
+    srand(seed);
+    lcg = seed;
+    num_ghosts = MAX_GHOSTS;
+    new_maze();
+    place_items();
+    df_stale = 1;
+    search();
+    sum = 0;
+
+    for (s = 0; s < steps; s++) {
+#ifdef REAL_TIME
+        /* The spare time before the tick */
+        lcg = lcg * 1103515245 + 12345;
+        for (k = slices ? (lcg >> 16) % (slices + 1) : 0; k; k--)
+            df_slice();
+#else
+        (void)k; (void)lcg;
+#endif
+        memcpy(last, ref, sizeof(ref));
+        d = rand() & 3;
+        nx = px + dx[d]; ny = py + dy[d];
+        if (!is_wall(nx, ny)) {
+            px = nx; py = ny;
+        } else if (!is_border(nx, ny) && rand() % 8 == 0) {
+            wall_clear(nx, ny);
+            px = nx; py = ny;
+            df_stale = 1;
+        } else {
+#ifndef REAL_TIME
+            continue;
+#endif
+        }                   /* else a tick without a step */
+        search();
+        for (d = 0, c = 0; c < CELLS; c++)
+            if (ref[c] != last[c]) d++;
+        df_work = 0;
+        move_ghosts(1);
+        for (k = 0; k < num_ghosts; k++)
+            sum = sum * 31 + CELL(ghost_x[k], ghost_y[k]);
+        if (slices) continue;
+
+        changed += d;
+        moves++;
+        if (d > most_changed) most_changed = d;
+        work += df_work;
+        turns++;
+        if ((int)df_work > most_work) {
+            most_work = df_work;
+            most_seed = seed;
+        }
+
+        if (df_stale || df_px != px || df_py != py) continue;
+        d = check_field();
+        if (d && !wrong)
+            printf("maze %d step %d: %d cells wrong\n", seed, s, d);
+        wrong += d;
+        checked++;
+    }
+    return sum;
+}
+
+int main(int argc, char **argv)
+{
+    int steps, seed, differ;
+    unsigned long sum;
+
+    steps = argc > 1 ? atoi(argv[1]) : 400;
+    differ = 0;
+    for (seed = 1; seed <= 255; seed++) {
+        sum = play(seed, steps, 0);
+#ifdef REAL_TIME
+        if (play(seed, steps, 6) != sum) {
+            if (!differ)
+                printf("maze %d: the ghosts went elsewhere with the "
+                       "task's slices\n", seed);
+            differ++;
+        }
+#else
+        (void)sum;
+#endif
+    }
+
+    printf("%ld turns, field checked on %ld: %ld cells wrong\n",
+           turns, checked, wrong);
+    printf("search: %.1f cells a turn, %d at most (maze %d)\n",
+           (double)work / turns, most_work, most_seed);
+    printf("a step changes %.1f cells' distances, %d at most\n",
+           (double)changed / moves, most_changed);
+#ifdef REAL_TIME
+    printf("%d mazes played differently with the task's slices\n",
+           differ);
+#endif
+    return wrong || differ ? 1 : 0;
+}
@@ -0,0 +1,220 @@
+#!/usr/bin/env python3
+# footprint.py - code and RAM used by a program, from its map file
+# by @mathsDOTearth on github
+# https://github.com/mathsDOTearth/CPCprogramming/
+#
+#   footprint.py prog.map [--top A] [--sp A --stack N]
+#                [--code N] [--data N] [--bss N] [--frame N]
+#                [--lis file.lis ...] [-n N]
+#
+# Reads the z88dk map file (zcc -m) and prints how much of each
+# kind of memory the program takes - code, read-only data, data
+# and BSS - with the biggest functions and tables in each.  An
+# item runs to the next C symbol, public symbol or section edge;
+# local labels inside asm don't split it.
+#
+# Given the assembly listings (zcc --list), it also prints the
+# biggest stack frames: what each C function takes from the
+# stack as it runs, its locals as sccz80 makes room for them on
+# entry (push bc, dec sp, or ld hl,-n / add hl,sp / ld sp,hl)
+# and the return address.  The arguments are its caller's, and
+# the stack its callees use comes on top.
+#
+# With budgets given it exits 1 (failing the build) if:
+#   --top A     the program runs to A or above: 0xA67B is HIMEM
+#               with AMSDOS, above which are the firmware's and
+#               AMSDOS's workspace, the jumpblocks and the screen
+#   --sp A      the program reaches the stack, which starts at A
+#   --stack N   ... and needs N bytes below it (default 256)
+#   --code N, --data N, --bss N
+#               one kind of memory is over N bytes (data includes
+#               read-only data)
+#   --frame N   a function's stack frame is over N bytes
+
+import argparse
+import os
+import re
+import sys
+
+KINDS = ('code', 'rodata', 'data', 'bss')
+
+
+def kind_of(section):
+    for k in ('rodata', 'code', 'data', 'bss'):
+        if section.startswith(k):
+            return k
+    return None
+
+
+def number(s):
+    return int(s, 0)
+
+
+def read_map(path):
+    """Addresses of the symbols, and of the section boundaries"""
+    items = []                  # (addr, name, kind)
+    marks = set()
+    pat = re.compile(r'^(\S+)\s*=\s*\$([0-9A-Fa-f]+)\s*;\s*(\w+)\s*,\s*(\w+)'
+                     r'\s*,[^,]*,[^,]*,\s*([^,\s]*)')
+    edge = re.compile(r'^__(\w+?)_(head|tail)$')
+    for line in open(path):
+        m = pat.match(line)
+        if not m:
+            continue
+        name, addr, typ, scope, section = m.groups()
+        addr = int(addr, 16)
+        e = edge.match(name)
+        if e:
+            if kind_of(e.group(1)):
+                marks.add(addr)
+            continue
+        if typ != 'addr' or name.startswith('__'):
+            continue
+        if scope != 'public' and not name.startswith('_'):
+            continue
+        k = kind_of(section)
+        if k:
+            items.append((addr, name, k))
+    return items, marks
+
+
+def read_frames(paths):
+    """Stack frame of each C function in the listings, by name"""
+    frames = {}
+    label = re.compile(r'^\.(_\w+)$|^(_\w+):$')
+    for path in paths:
+        if not os.path.exists(path):    # an unmatched *.lis
+            continue
+        name, size, sub, code = None, 0, None, True
+        for line in open(path, errors='replace'):
+            # line number, address and bytes, then the source
+            text = re.sub(r'^\s*\d+\s+[0-9A-Fa-f]{4}((\s+[0-9A-Fa-f]{2})+\s)?',
+                          '', line)
+            text = ' '.join(text.split(';')[0].split())
+            if not text:
+                continue
+            m = re.match(r'^section (\w+)$', text, re.I)
+            if m:
+                code = kind_of(m.group(1)) == 'code'
+            m = label.match(text)
+            if m and code:
+                if name:
+                    frames[name] = size + 2
+                name, size, sub = m.group(1) or m.group(2), 0, None
+                continue
+            if name is None:
+                continue
+            op = text.replace(', ', ',')
+            if sub is not None:
+                if op == 'add hl,sp' and sub[0] == 'add':
+                    sub = ('ld', sub[1])
+                    continue
+                if op == 'ld sp,hl' and sub[0] == 'ld':
+                    size += sub[1]
+                    sub = None
+                    continue
+            elif op == 'push bc':
+                size += 2
+                continue
+            elif op == 'dec sp':
+                size += 1
+                continue
+            else:
+                m = re.match(r'^ld hl,(-?\$?\w+)$', op)
+                if m:
+                    v = m.group(1).replace('$', '0x')
+                    try:
+                        v = int(v, 0)
+                    except ValueError:
+                        v = 0
+                    if -0x8000 <= v < 0 or v >= 0x8000:
+                        sub = ('add', (-v) & 0xFFFF)
+                        continue
+            frames[name] = size + 2
+            name = None
+        if name:
+            frames[name] = size + 2
+    return frames
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument('map')
+    ap.add_argument('--top', type=number)
+    ap.add_argument('--sp', type=number)
+    ap.add_argument('--stack', type=number, default=256)
+    ap.add_argument('--code', type=number)
+    ap.add_argument('--data', type=number)
+    ap.add_argument('--bss', type=number)
+    ap.add_argument('--frame', type=number)
+    ap.add_argument('--lis', nargs='*', default=[],
+                    help='assembly listings, for the stack frames')
+    ap.add_argument('-n', type=int, default=8, help='biggest items shown')
+    args = ap.parse_args()
+
+    items, marks = read_map(args.map)
+    if not items:
+        sys.exit('footprint.py: no code or data symbols in %s' % args.map)
+
+    # Each item runs to the next symbol or section boundary
+    bounds = sorted(set(a for a, _, _ in items) | marks)
+    end = bounds[-1]
+    total = dict((k, 0) for k in KINDS)
+    biggest = dict((k, []) for k in KINDS)
+    seen = set()
+    for addr, name, k in items:
+        if addr in seen:            # aliases share the bytes
+            continue
+        seen.add(addr)
+        i = bounds.index(addr)
+        n = bounds[i + 1] - addr if i + 1 < len(bounds) else 0
+        total[k] += n
+        biggest[k].append((n, name))
+    start = min(a for a, _, _ in items)
+
+    print('%s: 0x%04X-0x%04X, %d bytes' % (args.map, start, end - 1,
+                                            end - start))
+    for k in KINDS:
+        print('  %-7s %6d' % (k, total[k]))
+    for k in KINDS:
+        top = sorted(biggest[k], reverse=True)[:args.n]
+        if top:
+            print('biggest %s:' % k)
+            for n, name in top:
+                print('  %-28s %6d' % (name, n))
+    frames = read_frames(args.lis)
+    if frames:
+        print('biggest stack frames:')
+        top = sorted(((n, f) for f, n in frames.items()), reverse=True)
+        for n, name in top[:args.n]:
+            print('  %-28s %6d' % (name, n))
+
+    over = []
+    if args.top is not None:
+        print('free below 0x%04X: %d' % (args.top, args.top - end))
+        if end > args.top:
+            over.append('runs to 0x%04X, past 0x%04X' % (end, args.top))
+    if args.sp is not None:
+        room = args.sp - args.stack - end
+        print('free below the stack: %d' % room)
+        if room < 0:
+            over.append('reaches the %d bytes of stack below 0x%04X'
+                        % (args.stack, args.sp))
+    for k, limit in (('code', args.code), ('data', args.data),
+                     ('bss', args.bss)):
+        used = total[k] + (total['rodata'] if k == 'data' else 0)
+        if limit is not None and used > limit:
+            over.append('%s is %d bytes, budget %d' % (k, used, limit))
+    if args.frame is not None:
+        for f, n in sorted(frames.items()):
+            if n > args.frame:
+                over.append('%s has a %d byte stack frame, budget %d'
+                            % (f, n, args.frame))
+    if over:
+        for msg in over:
+            print('footprint.py: OVER BUDGET: %s' % msg, file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,100 @@
+/*
+ * keyscript - turn a key file into a script built into the game
+ * Host tool, build with gcc (see tools/Makefile)
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * Writes key_script[] for a game built with INPUT=script, in the
+ * log layout described in mazecore/input.h.
+ *
+ *   keyscript session.keys keyscript.c
+ *
+ * The input is either the keys themselves, one byte each as the
+ * game reads them (a newline is ENTER), or a KEYS.REC recorded by
+ * an INPUT=record build, with or without its AMSDOS header.  Build
+ * it with the same -D options as the game: a script from one maze
+ * size or generator is ignored by another.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "input.h"
+
+static unsigned char in[65536];
+static unsigned char out[2 * 65536 + 4];
+
+int main(int argc, char **argv)
+{
+    FILE *f;
+    unsigned char *log;
+    int len, n, i, keys;
+
+    if (argc != 3) {
+        fprintf(stderr, "usage: keyscript keys.txt|KEYS.REC keyscript.c\n");
+        return 1;
+    }
+    f = fopen(argv[1], "rb");
+    if (f == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    len = fread(in, 1, sizeof(in), f);
+    fclose(f);
+
+    /* A recorded log is copied as it is */
+    if (len >= 4 && in[0] == 'K' && in[1] == 'L') {
+        log = in;
+    } else if (len >= 132 && in[128] == 'K' && in[129] == 'L') {
+        log = in + 128;
+        len -= 128;
+    } else {
+        log = NULL;
+    }
+    if (log != NULL) {
+        if (log[2] != MAZE_SHIFT || log[3] != KEY_LOG_GEN) {
+            fprintf(stderr, "keyscript: %s was recorded with other "
+                            "maze options\n", argv[1]);
+            return 1;
+        }
+        n = len & ~1;
+        memcpy(out, log, n);
+    } else {
+        out[0] = 'K'; out[1] = 'L';
+        out[2] = MAZE_SHIFT; out[3] = KEY_LOG_GEN;
+        n = 4;
+        for (i = 0; i < len; i++) {
+            if (n > 4 && out[n - 1] == in[i] && out[n - 2] != 255) {
+                out[n - 2]++;
+                continue;
+            }
+            out[n++] = 1;
+            out[n++] = in[i];
+        }
+    }
+
+    keys = 0;
+    for (i = 4; i < n; i += 2)
+        keys += out[i];
+
+    f = fopen(argv[2], "w");
+    if (f == NULL) {
+        perror(argv[2]);
+        return 1;
+    }
+    fprintf(f, "/* Written by tools/keyscript from %s - keys: %d */\n\n",
+            argv[1], keys);
+    fprintf(f, "const unsigned char key_script[] = {");
+    for (i = 0; i < n; i++)
+        fprintf(f, "%s0x%02X", i % 12 ? ", " : (i ? ",\n    " : "\n    "),
+                out[i]);
+    fprintf(f, "\n};\nconst unsigned int key_script_len = %d;\n", n);
+    if (fclose(f) != 0) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    fprintf(stderr, "keyscript: %d keys in %d bytes\n", keys, n);
+    return 0;
+}
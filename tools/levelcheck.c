@@ -0,0 +1,217 @@
+/*
+ * levelcheck - check every maze number for a fair game
+ * Host tool, build with gcc (see tools/Makefile)
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * Builds mazes 1-255 with the games' own mazecore code and works
+ * out the cheapest way to collect every gem and reach the exit
+ * without parting a hedge, counting energy the way the game does:
+ * 2 per step forwards or backwards, 1 per quarter turn.  Ghosts
+ * are not counted; instead a maze is only passed if two ghost
+ * hits would still leave energy to spare.
+ *
+ *   levelcheck        write seedtab.h to stdout
+ *   levelcheck -v     per-maze report instead
+ *
+ * Build it with the same -D options as the game (MAZE_SHIFT,
+ * MAZE_GEN_ELLER, RNG_FAST_LAYOUT) - the table it writes refuses
+ * to compile into a game built differently.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rng.h"
+#include "mazegen.h"
+
+#define START_ENERGY  500
+#define GHOST_HIT      50
+#define BUDGET        (START_ENERGY - 2 * GHOST_HIT)
+
+#define CELLS   (MAZE_W * MAZE_H)
+#define STATES  (CELLS * 4)      /* cell and facing */
+#define POINTS  (NUM_GEMS + 2)   /* start, gems, exit */
+#define FAR     0x7FFFFFFF
+
+/* cost[a][da][b][db]: cheapest from point a facing da to point b
+ * facing db */
+static int cost[POINTS][4][POINTS][4];
+static int best[1 << NUM_GEMS][NUM_GEMS][4];
+static int sdist[STATES];
+
+static unsigned char pt_x[POINTS], pt_y[POINTS];
+
+/* Dijkstra over (cell, facing); edge costs are 1 or 2, so a
+ * ring of three buckets is enough */
+static void search(int from)
+{
+    static int bucket[3][STATES], len[3];
+    int d, i, s, c, dir, n, k;
+
+    for (i = 0; i < STATES; i++) sdist[i] = FAR;
+    memset(len, 0, sizeof(len));
+    sdist[from] = 0;
+    bucket[0][len[0]++] = from;
+
+    for (d = 0; len[0] + len[1] + len[2]; d++) {
+        k = d % 3;
+        for (i = 0; i < len[k]; i++) {
+            s = bucket[k][i];
+            if (sdist[s] != d) continue;
+            c = s >> 2; dir = s & 3;
+            /* turns */
+            n = (c << 2) | ((dir + 1) & 3);
+            if (d + 1 < sdist[n]) { sdist[n] = d + 1; bucket[(d + 1) % 3][len[(d + 1) % 3]++] = n; }
+            n = (c << 2) | ((dir + 3) & 3);
+            if (d + 1 < sdist[n]) { sdist[n] = d + 1; bucket[(d + 1) % 3][len[(d + 1) % 3]++] = n; }
+            /* step forwards, then backwards */
+            n = c + dx[dir] + dy[dir] * MAZE_W;
+            if (!WALL_AT(n) && d + 2 < sdist[(n << 2) | dir]) {
+                sdist[(n << 2) | dir] = d + 2;
+                bucket[(d + 2) % 3][len[(d + 2) % 3]++] = (n << 2) | dir;
+            }
+            n = c - dx[dir] - dy[dir] * MAZE_W;
+            if (!WALL_AT(n) && d + 2 < sdist[(n << 2) | dir]) {
+                sdist[(n << 2) | dir] = d + 2;
+                bucket[(d + 2) % 3][len[(d + 2) % 3]++] = (n << 2) | dir;
+            }
+        }
+        len[k] = 0;
+    }
+}
+
+/* Cheapest energy for the whole level, or -1 if some gem or the
+ * exit can't be reached without parting a hedge */
+static int level_cost(void)
+{
+    int a, b, da, db, m, i, j, c, full, total;
+
+    pt_x[0] = START_X; pt_y[0] = START_Y;
+    for (i = 0; i < NUM_GEMS; i++) {
+        pt_x[i + 1] = gem_x[i]; pt_y[i + 1] = gem_y[i];
+    }
+    pt_x[POINTS - 1] = exit_x; pt_y[POINTS - 1] = exit_y;
+
+    for (a = 0; a < POINTS - 1; a++)
+        for (da = 0; da < 4; da++) {
+            search((CELL(pt_x[a], pt_y[a]) << 2) | da);
+            for (b = 0; b < POINTS; b++)
+                for (db = 0; db < 4; db++)
+                    cost[a][da][b][db] = sdist[(CELL(pt_x[b], pt_y[b]) << 2) | db];
+        }
+
+    /* Gems in every order: best[set][last gem][facing] */
+    full = (1 << NUM_GEMS) - 1;
+    for (m = 0; m <= full; m++)
+        for (i = 0; i < NUM_GEMS; i++)
+            for (db = 0; db < 4; db++)
+                best[m][i][db] = FAR;
+    for (i = 0; i < NUM_GEMS; i++)
+        for (db = 0; db < 4; db++)
+            best[1 << i][i][db] = cost[0][DIR_E][i + 1][db];
+
+    for (m = 1; m <= full; m++)
+        for (i = 0; i < NUM_GEMS; i++)
+            for (da = 0; da < 4; da++) {
+                if (best[m][i][da] == FAR) continue;
+                for (j = 0; j < NUM_GEMS; j++) {
+                    if (m & (1 << j)) continue;
+                    for (db = 0; db < 4; db++) {
+                        c = cost[i + 1][da][j + 1][db];
+                        if (c == FAR) continue;
+                        c += best[m][i][da];
+                        if (c < best[m | (1 << j)][j][db])
+                            best[m | (1 << j)][j][db] = c;
+                    }
+                }
+            }
+
+    total = FAR;
+    for (i = 0; i < NUM_GEMS; i++)
+        for (da = 0; da < 4; da++) {
+            if (best[full][i][da] == FAR) continue;
+            for (db = 0; db < 4; db++) {
+                c = cost[i + 1][da][POINTS - 1][db];
+                if (c != FAR && best[full][i][da] + c < total)
+                    total = best[full][i][da] + c;
+            }
+        }
+    return total == FAR ? -1 : total;
+}
+
+static int seed_cost[256];
+
+static int by_cost(const void *a, const void *b)
+{
+    int sa = *(const unsigned char *)a, sb = *(const unsigned char *)b;
+    if (seed_cost[sa] != seed_cost[sb]) return seed_cost[sa] - seed_cost[sb];
+    return sa - sb;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned char good[255];
+    int verbose, n, seed, bad_path, bad_cost, lo, hi;
+
+    verbose = (argc > 1 && strcmp(argv[1], "-v") == 0);
+    n = 0; bad_path = 0; bad_cost = 0; lo = FAR; hi = 0;
+
+    for (seed = 1; seed <= 255; seed++) {
+        rng_layout_seed(seed);
+        generate_maze();
+        place_layout();
+        seed_cost[seed] = level_cost();
+
+        if (verbose)
+            printf("%3d  %s %d\n", seed,
+                   seed_cost[seed] < 0 ? "no path " :
+                   seed_cost[seed] > BUDGET ? "too dear" : "ok      ",
+                   seed_cost[seed]);
+        if (seed_cost[seed] < 0) { bad_path++; continue; }
+        if (seed_cost[seed] > BUDGET) { bad_cost++; continue; }
+        if (seed_cost[seed] < lo) lo = seed_cost[seed];
+        if (seed_cost[seed] > hi) hi = seed_cost[seed];
+        good[n++] = seed;
+    }
+
+    if (verbose) {
+        printf("%d fair, %d need a hedge parted, %d cost over %d\n",
+               n, bad_path, bad_cost, BUDGET);
+        return 0;
+    }
+    if (n == 0)
+        fprintf(stderr, "levelcheck: no fair mazes - the game will "
+                        "pick from all 255\n");
+    else
+        qsort(good, n, 1, by_cost);
+    if (lo > hi) lo = hi = 0;
+
+    printf("/* seedtab.h - written by tools/levelcheck, do not edit.\n");
+    printf(" * The %d maze numbers that can be finished without parting\n", n);
+    printf(" * a hedge for at most %d energy, cheapest first (%d-%d).\n", BUDGET, lo, hi);
+    printf(" * %d left out: %d need a hedge parted, %d cost too much. */\n\n",
+           255 - n, bad_path, bad_cost);
+    printf("#if MAZE_SHIFT != %d\n#error seedtab.h is for another maze size - rebuild it\n#endif\n", MAZE_SHIFT);
+#ifdef MAZE_GEN_ELLER
+    printf("#ifndef MAZE_GEN_ELLER\n");
+#else
+    printf("#ifdef MAZE_GEN_ELLER\n");
+#endif
+    printf("#error seedtab.h is for another maze carver - rebuild it\n#endif\n");
+#ifdef RNG_FAST_LAYOUT
+    printf("#ifndef RNG_FAST_LAYOUT\n");
+#else
+    printf("#ifdef RNG_FAST_LAYOUT\n");
+#endif
+    printf("#error seedtab.h is for another layout RNG - rebuild it\n#endif\n\n");
+
+    printf("#define SEED_COUNT %d\n", n);
+    if (n == 0) return 0;
+    printf("\nconst unsigned char seed_by_cost[SEED_COUNT] = {");
+    for (seed = 0; seed < n; seed++)
+        printf("%s%3d,", seed % 12 ? " " : "\n   ", good[seed]);
+    printf("\n};\n");
+    return 0;
+}
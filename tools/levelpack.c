@@ -0,0 +1,149 @@
+/*
+ * levelpack - write the precomputed maze pack
+ * Host tool, build with gcc (see tools/Makefile)
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * Builds mazes 1-255 with the games' own mazecore code and packs
+ * their walls, gems and exit in the format described in
+ * mazecore/levelpak.h, PACK_GROUP mazes to a file.
+ *
+ *   levelpack levels     writes levels00.pak to levels1f.pak
+ *
+ * Build it with the same -D options as the game.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rng.h"
+#include "mazegen.h"
+#include "levelpak.h"
+
+/* Hedge slots: odd y with even x, and even y with odd x */
+#define SLOTS    (((MAZE_H - 2) / 2) * ((MAZE_W - 4) / 2) + \
+                  ((MAZE_H - 4) / 2) * ((MAZE_W - 2) / 2))
+#define REC_MAX  (2 + (1 + NUM_GEMS) * PACK_CELL + SLOTS / 8 + 2 + \
+                  255 * PACK_CELL)
+
+static unsigned char rec[255][REC_MAX];
+static int rec_len[255];
+static int slot_bytes, patches;
+
+static int put_cell(unsigned char *out, int len, int c)
+{
+    out[len++] = c & 0xFF;
+#if PACK_CELL == 2
+    out[len++] = c >> 8;
+#endif
+    return len;
+}
+
+/* Record for the maze just carved and given its gems */
+static int pack_maze(unsigned char *out, unsigned int state)
+{
+    static unsigned int lattice[WALL_WORDS];
+    unsigned char bits, mask;
+    int len, i, x, y, c, count, count_at;
+
+    len = 0;
+    out[len++] = state & 0xFF;
+    out[len++] = state >> 8;
+    len = put_cell(out, len, CELL(exit_x, exit_y));
+    for (i = 0; i < NUM_GEMS; i++)
+        len = put_cell(out, len, CELL(gem_x[i], gem_y[i]));
+
+    /* Slot bits, building the map the loader will see as we go */
+    memset(lattice, 0xFF, sizeof(lattice));
+    bits = 0; mask = 0x80; i = len;
+    for (y = 1; y < MAZE_H - 2; y++)
+        for (x = 1; x < MAZE_W - 2; x++) {
+            c = CELL(x, y);
+            if (x & y & 1) { lattice[c >> 4] &= ~cell_bit[c & 15]; continue; }
+            if (!((x | y) & 1)) continue;
+            if (!is_wall(x, y)) {
+                bits |= mask;
+                lattice[c >> 4] &= ~cell_bit[c & 15];
+            }
+            mask >>= 1;
+            if (!mask) { out[len++] = bits; bits = 0; mask = 0x80; }
+        }
+    if (mask != 0x80) out[len++] = bits;
+    slot_bytes += len - i;
+
+    /* Whatever the lattice got wrong */
+    count_at = len++;
+    count = 0;
+    for (c = 0; c < MAZE_W * MAZE_H; c++)
+        if ((wall[c >> 4] ^ lattice[c >> 4]) & cell_bit[c & 15]) {
+            if (count == 255) {
+                fprintf(stderr, "levelpack: too many cells off the "
+                                "lattice\n");
+                exit(1);
+            }
+            len = put_cell(out, len, c);
+            count++;
+        }
+    out[count_at] = count;
+    patches += count;
+    return len;
+}
+
+int main(int argc, char **argv)
+{
+    char name[FILENAME_MAX];
+    FILE *f;
+    int n, i, first, count, at, total, most;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: levelpack levels\n");
+        return 1;
+    }
+
+    for (n = 0; n < 255; n++) {
+        rng_layout_seed(n + 1);
+        generate_maze();
+        place_gems();
+        rec_len[n] = pack_maze(rec[n], rng_layout_state);
+    }
+
+    /* Each file's records are at most PACK_GROUP x REC_MAX bytes,
+     * well inside the 16-bit offsets */
+    total = most = 0;
+    for (first = 0; first < 255; first += PACK_GROUP) {
+        count = 255 - first < PACK_GROUP ? 255 - first : PACK_GROUP;
+        snprintf(name, sizeof(name), "%s%02x.pak", argv[1],
+                 first / PACK_GROUP);
+        f = fopen(name, "wb");
+        if (f == NULL) {
+            perror(name);
+            return 1;
+        }
+        fputc('M', f); fputc('Z', f); fputc(MAZE_SHIFT, f);
+        fputc(first + 1, f); fputc(count, f);
+        at = 0;
+        for (i = first; i < first + count; i++) {
+            fputc(at & 0xFF, f);
+            fputc(at >> 8, f);
+            at += rec_len[i];
+        }
+        for (i = first; i < first + count; i++)
+            fwrite(rec[i], 1, rec_len[i], f);
+        if (fclose(f) != 0) {
+            perror(name);
+            return 1;
+        }
+        total += 5 + 2 * count + at;
+        /* What the loader reads to reach the file's last maze */
+        at += 5 + 2 * count - rec_len[first + count - 1];
+        if (at > most) most = at;
+    }
+
+    fprintf(stderr, "levelpack: 255 mazes in %d bytes, %d files "
+                    "(wall maps %d bytes as %d of slots and %d "
+                    "patches); at most %d bytes read before a maze\n",
+            total, (255 + PACK_GROUP - 1) / PACK_GROUP,
+            255 * WALL_WORDS * 2, slot_bytes, patches, most);
+    return 0;
+}
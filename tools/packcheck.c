@@ -0,0 +1,94 @@
+/*
+ * packcheck - check that the level pack gives the mazes carving does
+ * Host tool, build with gcc (see tools/Makefile)
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * For mazes 1-255, carves each with the games' own mazecore code
+ * as a LEVELS=carve game would, then reads it from the pack with
+ * the loader a LEVELS=pack game uses (mazecore/levelpak.c, with
+ * the host's disc.c).  After the ghosts are placed, both ways
+ * must give the same hedges, gems, exit, ghosts and layout stream.
+ *
+ *   packcheck         reads levels00.pak-levels1f.pak in this
+ *                     directory
+ *
+ * Build it with the same -D options as levelpack; it exits 1 if
+ * any maze differed or couldn't be read.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "rng.h"
+#include "mazegen.h"
+#include "levelpak.h"
+
+/* What place_layout() leaves, for comparing */
+struct layout {
+    unsigned int wall[WALL_WORDS];
+    unsigned char gem_x[NUM_GEMS], gem_y[NUM_GEMS];
+    unsigned char exit_x, exit_y;
+    unsigned char ghost_x[MAX_GHOSTS], ghost_y[MAX_GHOSTS];
+    unsigned char ghost_wait[MAX_GHOSTS];
+    unsigned int state;
+};
+
+/* Only the low 16 bits of a wall word are cells; memset() leaves
+ * the rest of a wider host int set, and that means nothing */
+static void take(struct layout *l)
+{
+    int i;
+
+    memset(l, 0, sizeof(*l));
+    for (i = 0; i < WALL_WORDS; i++)
+        l->wall[i] = wall[i] & 0xFFFF;
+    memcpy(l->gem_x, gem_x, NUM_GEMS);
+    memcpy(l->gem_y, gem_y, NUM_GEMS);
+    l->exit_x = exit_x; l->exit_y = exit_y;
+    memcpy(l->ghost_x, ghost_x, MAX_GHOSTS);
+    memcpy(l->ghost_y, ghost_y, MAX_GHOSTS);
+    memcpy(l->ghost_wait, ghost_wait, MAX_GHOSTS);
+    l->state = rng_layout_state;
+}
+
+int main(void)
+{
+    struct layout carved, packed;
+    int n, loaded, bad;
+
+    num_ghosts = MAX_GHOSTS;
+    loaded = bad = 0;
+    for (n = 1; n <= 255; n++) {
+        rng_layout_seed(n);
+        generate_maze();
+        place_gems();
+        place_ghosts();
+        take(&carved);
+
+        /* Scribble over it all, so the loader has to fill it in */
+        memset(wall, 0x55, sizeof(wall));
+        memset(gem_x, 0, NUM_GEMS); memset(gem_y, 0, NUM_GEMS);
+        exit_x = exit_y = 0;
+        rng_layout_state = 0;
+        if (!pack_load(n)) {
+            if (!bad)
+                printf("maze %d: not in the pack\n", n);
+            bad++;
+            continue;
+        }
+        place_ghosts();
+        take(&packed);
+        loaded++;
+
+        if (memcmp(&carved, &packed, sizeof(carved))) {
+            if (!bad)
+                printf("maze %d: the pack gives a different maze\n", n);
+            bad++;
+        }
+    }
+
+    printf("%d mazes read from the pack, %d missing or different\n",
+           loaded, bad);
+    return bad ? 1 : 0;
+}
@@ -0,0 +1,276 @@
+#!/usr/bin/env python3
+# profile.py - per-function hot list from a z88dk-ticks trace
+# by @mathsDOTearth on github
+# https://github.com/mathsDOTearth/CPCprogramming/
+#
+#   z88dk-ticks -trace ... prog.img | profile.py prog.map prog.img
+#
+# Only the address of each instruction is taken from the trace
+# (the first four-digit hex number on a line).  The T-states come
+# from the instruction's own bytes in the memory image, and the
+# next address tells whether a conditional jump, call or return
+# was taken and whether an LDIR-style loop went round again.
+# Each instruction's time goes to the function it lies in, from
+# the public code symbols in the map file, so the figures are
+# self time: a function's callees are counted separately.  A call
+# is a CALL or RST arriving in the function.
+#
+# --cpc rounds each instruction up to a whole number of 4 T-state
+# slots, as the CPC's Gate Array holds the Z80 to them: the time
+# it takes on the machine rather than on a bare Z80.  --calls FUNC
+# also prints the fewest, most and mean T-states of a call to
+# FUNC, from its first instruction to where it leaves for its
+# caller, without the time in anything it calls outside itself.
+
+import argparse
+import bisect
+import re
+import sys
+
+FIRMWARE = (0xBB00, 0xBE00)     # jumpblock, RET stubs in ticks.sh
+
+
+def base_op(op):
+    """(length, T, T when taken, kind) for an unprefixed opcode.
+    kind: 'cond' taken if the next PC isn't the next instruction,
+    'call' always a call, 'ccall' a call when taken."""
+    x, y, z = op >> 6, (op >> 3) & 7, op & 7
+    if x == 1:
+        if op == 0x76:
+            return 1, 4, 4, None                    # halt
+        return 1, 7 if (y == 6 or z == 6) else 4, 0, None
+    if x == 2:
+        return 1, 7 if z == 6 else 4, 0, None
+    if x == 0:
+        if z == 0:
+            if y < 2:
+                return 1, 4, 0, None                # nop, ex af,af'
+            if y == 2:
+                return 2, 8, 13, 'cond'             # djnz
+            if y == 3:
+                return 2, 12, 0, None               # jr
+            return 2, 7, 12, 'cond'                 # jr cc
+        if z == 1:
+            return (3, 10, 0, None) if y % 2 == 0 else (1, 11, 0, None)
+        if z == 2:
+            if y < 4:
+                return 1, 7, 0, None
+            return 3, 16 if y < 6 else 13, 0, None
+        if z == 3:
+            return 1, 6, 0, None
+        if z in (4, 5):
+            return 1, 11 if y == 6 else 4, 0, None
+        if z == 6:
+            return 2, 10 if y == 6 else 7, 0, None
+        return 1, 4, 0, None
+    # x == 3
+    if z == 0:
+        return 1, 5, 11, 'cond'                     # ret cc
+    if z == 1:
+        if y % 2 == 0:
+            return 1, 10, 0, None                   # pop
+        return 1, (10, 4, 4, 6)[y >> 1], 0, None    # ret exx jp(hl) ld sp
+    if z == 2:
+        return 3, 10, 0, None                       # jp cc
+    if z == 3:
+        if y == 0:
+            return 3, 10, 0, None
+        if y in (2, 3):
+            return 2, 11, 0, None                   # out (n),a / in a,(n)
+        if y == 4:
+            return 1, 19, 0, None
+        return 1, 4, 0, None
+    if z == 4:
+        return 3, 10, 17, 'ccall'
+    if z == 5:
+        if y % 2 == 0:
+            return 1, 11, 0, None                   # push
+        return 3, 17, 0, 'call'
+    if z == 6:
+        return 2, 7, 0, None
+    return 1, 11, 0, 'call'                         # rst
+
+
+def ed_op(op):
+    x, y, z = op >> 6, (op >> 3) & 7, op & 7
+    if x == 1:
+        if z == 3:
+            return 4, 20, 0, None
+        if z == 7:
+            return 2, 9 if y < 4 else (18 if y < 6 else 8), 0, None
+        return 2, (12, 12, 15, 0, 8, 14, 8)[z], 0, None
+    if x == 2 and z < 4 and y >= 4:
+        if y >= 6:
+            return 2, 16, 21, 'rep'                 # ldir, cpir, ...
+        return 2, 16, 0, None
+    return 2, 8, 0, None
+
+
+def uses_hl_mem(op):
+    x, y, z = op >> 6, (op >> 3) & 7, op & 7
+    if x == 1 and op != 0x76:
+        return y == 6 or z == 6
+    if x == 2:
+        return z == 6
+    return op in (0x34, 0x35, 0x36)
+
+
+INDEX_OPS = {0x21: (4, 14), 0x22: (4, 20), 0x2A: (4, 20), 0x23: (2, 10),
+             0x2B: (2, 10), 0x09: (2, 15), 0x19: (2, 15), 0x29: (2, 15),
+             0x39: (2, 15), 0xE1: (2, 14), 0xE5: (2, 15), 0xE3: (2, 23),
+             0xE9: (2, 8), 0xF9: (2, 10)}
+
+
+def decode(mem, pc):
+    op = mem[pc]
+    if op == 0xCB:
+        op2 = mem[(pc + 1) & 0xFFFF]
+        if op2 & 7 == 6:
+            return 2, 12 if op2 >> 6 == 1 else 15, 0, None
+        return 2, 8, 0, None
+    if op == 0xED:
+        return ed_op(mem[(pc + 1) & 0xFFFF])
+    if op in (0xDD, 0xFD):
+        op2 = mem[(pc + 1) & 0xFFFF]
+        if op2 == 0xCB:
+            op4 = mem[(pc + 3) & 0xFFFF]
+            return 4, 20 if op4 >> 6 == 1 else 23, 0, None
+        if op2 in (0xDD, 0xED, 0xFD):
+            return 1, 4, 0, None
+        if uses_hl_mem(op2):
+            if op2 == 0x36:
+                return 4, 19, 0, None
+            if op2 in (0x34, 0x35):
+                return 3, 23, 0, None
+            return 3, 19, 0, None
+        if op2 in INDEX_OPS:
+            n, t = INDEX_OPS[op2]
+            return n, t, 0, None
+        n, t, ta, kind = base_op(op2)
+        return n + 1, t + 4, ta + 4 if ta else 0, kind
+    return base_op(op)
+
+
+def read_map(path, everything):
+    """Sorted (address, name) of the code symbols"""
+    sym = {}
+    pat = re.compile(r'^(\S+)\s*=\s*\$([0-9A-Fa-f]+)\s*;\s*(\w+)\s*,\s*(\w+)'
+                     r'\s*,[^,]*,[^,]*,\s*([^,\s]*)')
+    for line in open(path):
+        m = pat.match(line)
+        if not m:
+            continue
+        name, addr, kind, scope, section = m.groups()
+        if kind != 'addr' or name.startswith('__'):
+            continue
+        if not section.startswith('code'):
+            continue
+        if scope != 'public' and not everything:
+            continue
+        sym.setdefault(int(addr, 16), name)
+    return sorted(sym.items())
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__)
+    ap.add_argument('map')
+    ap.add_argument('image', help='64K memory image the trace ran on')
+    ap.add_argument('-n', type=int, default=25, help='lines of hot list')
+    ap.add_argument('-a', action='store_true',
+                    help='split functions at local labels too')
+    ap.add_argument('--cpc', action='store_true',
+                    help='round each instruction up to a multiple of 4')
+    ap.add_argument('--calls', metavar='FUNC',
+                    help='time each call to FUNC')
+    ap.add_argument('--pc-regex', default=r'^\s*([0-9A-Fa-f]{4})\b',
+                    help='how to find the address in a trace line')
+    args = ap.parse_args()
+
+    mem = open(args.image, 'rb').read()
+    if len(mem) < 0x10000:
+        mem += bytes(0x10000 - len(mem))
+    syms = read_map(args.map, args.a)
+    starts = [a for a, _ in syms]
+    pcre = re.compile(args.pc_regex)
+    span = None
+    if args.calls:
+        for i, (a, name) in enumerate(syms):
+            if name == args.calls:
+                span = (a, syms[i + 1][0] if i + 1 < len(syms) else 0x10000)
+        if span is None:
+            sys.exit('profile.py: %s is not in %s' % (args.calls, args.map))
+
+    ops = {}            # pc -> decoded instruction
+    where = {}          # pc -> function name
+    ticks = {}
+    calls = {}
+
+    def func(pc):
+        f = where.get(pc)
+        if f is None:
+            if FIRMWARE[0] <= pc < FIRMWARE[1]:
+                f = '(firmware)'
+            else:
+                i = bisect.bisect_right(starts, pc) - 1
+                f = syms[i][1] if i >= 0 else '(unknown)'
+            where[pc] = f
+        return f
+
+    prev = None
+    total = 0
+    per_call = []       # T-states of each call to --calls
+    cur = None          # ... of the one under way
+    for line in sys.stdin:
+        m = pcre.match(line)
+        if not m:
+            continue
+        pc = int(m.group(1), 16)
+        if prev is not None:
+            n, t, ta, kind = ops[prev]
+            jumped = pc != (prev + n) & 0xFFFF
+            if kind == 'rep':
+                jumped = pc == prev
+            if jumped and kind in ('cond', 'rep', 'ccall'):
+                t = ta
+            if args.cpc:
+                t = (t + 3) & ~3
+            if span:
+                inside = span[0] <= prev < span[1]
+                if cur is not None and inside:
+                    cur += t
+                if kind == 'call' or (kind == 'ccall' and jumped):
+                    if pc == span[0] and cur is None:
+                        cur = 0
+                elif cur is not None and inside and \
+                        not span[0] <= pc < span[1]:
+                    per_call.append(cur)
+                    cur = None
+            if kind == 'call' or (kind == 'ccall' and jumped):
+                f = func(pc)
+                calls[f] = calls.get(f, 0) + 1
+            f = func(prev)
+            ticks[f] = ticks.get(f, 0) + t
+            total += t
+        if pc not in ops:
+            ops[pc] = decode(mem, pc)
+        prev = pc
+
+    if not total:
+        sys.exit('profile.py: no trace lines matched')
+    print('%-28s %9s %12s %6s' % ('function', 'calls', 'T-states', '%'))
+    hot = sorted(ticks.items(), key=lambda kv: -kv[1])
+    for f, t in hot[:args.n]:
+        print('%-28s %9d %12d %6.2f' % (f, calls.get(f, 0), t,
+                                         100.0 * t / total))
+    print('%-28s %9s %12d' % ('total', '', total))
+    if span:
+        if not per_call:
+            sys.exit('profile.py: no call to %s returned' % args.calls)
+        print('%s: %d calls, %d to %d T-states, %.0f on average%s' %
+              (args.calls, len(per_call), min(per_call), max(per_call),
+               float(sum(per_call)) / len(per_call),
+               ' (CPC)' if args.cpc else ''))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,18 @@
+#!/bin/sh
+# sizes.sh - binary sizes and disc load times, side by side
+# by @mathsDOTearth on github
+# https://github.com/mathsDOTearth/CPCprogramming/
+#
+#   sizes.sh prog.bin ...
+#
+# The load time is an estimate: AMSDOS reads a file at roughly
+# 2.5K a second, the drive's seek and spin-up aside.  Set RATE
+# (bytes a second) to use a figure timed on your own machine.
+
+RATE=${RATE:-2560}
+printf '%-16s %8s %8s\n' binary bytes 'load s'
+for f; do
+    n=$(wc -c < "$f")
+    printf '%-16s %8d %8s\n' "$f" "$n" \
+        "$(awk -v n="$n" -v r="$RATE" 'BEGIN { printf "%.1f", n / r }')"
+done
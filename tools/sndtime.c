@@ -0,0 +1,76 @@
+/*
+ * sndtime - step the sound player through its states, for timing
+ * CPC program, build with zcc (see make sndticks in either game)
+ *
+ * by @mathsDOTearth on github
+ * https://github.com/mathsDOTearth/CPCprogramming/
+ *
+ * Calls snd_frame (mazecore/sound.c) as the frame flyback hook
+ * would, through these states:
+ *
+ *   - the tune from its start, twice round its order, with no
+ *     effect and then with each effect in turn, asked for again
+ *     the frame after it ends, so its steps fall on every part
+ *     of the tune; each pass starts from silence, so its first
+ *     frame starts the tune and the effect at once
+ *   - the more important effects asked for over each effect
+ *   - the tune stopped, with and without an effect playing
+ *
+ * It does nothing else, and stops at sndtime_end().  Run under
+ * z88dk-ticks with ticks.sh -c _snd_frame, which gives the fewest
+ * and most T-states a call took with the CPC's wait states.
+ */
+
+#include "sound.h"
+
+extern unsigned char snd_prio;
+
+/* Frames in twice round the tune */
+static unsigned int tune_frames(const struct tune *t)
+{
+    const unsigned char *o;
+    unsigned int n;
+
+    n = 0;
+    for (o = t->order; *o != SND_END; o++)
+        n++;
+    return 2 * n * SND_ROWS * t->speed;
+}
+
+/* n frames, asking for effect fx whenever nothing is playing */
+static void frames(unsigned int n, unsigned char fx)
+{
+    while (n--) {
+        if (fx && !snd_prio)
+            snd_sfx(fx);
+        snd_frame();
+    }
+}
+
+void sndtime_end(void)
+{
+}
+
+int main(void)
+{
+    unsigned int n;
+    unsigned char fx, over;
+
+    n = tune_frames(&tune_maze);
+    for (fx = 0; fx <= SFX_LEVEL; fx++) {
+        snd_done();
+        snd_music(&tune_maze);
+        frames(n, fx);
+        for (over = fx + 1; over <= SFX_LEVEL; over++) {
+            snd_sfx(over);
+            frames(3, 0);
+            snd_sfx(fx);
+            frames(3, 0);
+        }
+        snd_music(0);
+        frames(2, fx);
+        frames(40, 0);
+    }
+    sndtime_end();
+    return 0;
+}
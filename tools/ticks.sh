@@ -0,0 +1,67 @@
+#!/bin/sh
+# ticks.sh - run a CPC program under z88dk-ticks
+# by @mathsDOTearth on github
+# https://github.com/mathsDOTearth/CPCprogramming/
+#
+#   ticks.sh [-p | -c func] prog.cpc prog.map end_symbol [keys]
+#
+# ticks has no CPC ROM, so the program is laid out at its load
+# address in a 64K memory image with RET at every firmware entry
+# (0xBB00-0xBDFF): firmware calls return at once and cost almost
+# nothing, and there are no interrupts.  The run starts at the
+# entry address in the AMSDOS header and stops when end_symbol
+# (from the z88dk map file) is reached.  Given the number of keys
+# in the session, it also prints the T-states per key.
+#
+# With -p the run is traced and profile.py prints a hot list of
+# where the time went, function by function.  With -c func it
+# also times each call to func, with the CPC's wait states: each
+# instruction rounded up to a multiple of 4 T-states (profile.py
+# --cpc --calls).
+
+set -e
+PROF=
+PROFOPTS=
+if [ "$1" = "-p" ]; then
+    PROF=1
+    shift
+elif [ "$1" = "-c" ]; then
+    PROF=1
+    PROFOPTS="--cpc --calls $2"
+    shift 2
+fi
+CPC=$1
+MAP=$2
+END=$3
+KEYS=$4
+TICKS=${TICKS:-z88dk-ticks}
+
+# 16-bit little-endian word at offset $1 of the AMSDOS header
+hdr() {
+    od -An -tu1 -j"$1" -N2 "$CPC" | awk '{ print $1 + 256 * $2 }'
+}
+LOAD=$(hdr 21)
+ENTRY=$(hdr 26)
+ENDADDR=$(awk -v s="$END" '$1 == s { sub(/^\$/, "", $3); print $3 }' "$MAP")
+if [ -z "$ENDADDR" ]; then
+    echo "ticks.sh: $END is not in $MAP" >&2
+    exit 1
+fi
+
+IMG=${CPC%.cpc}.img
+head -c 65536 /dev/zero > "$IMG"
+printf '\311%.0s' $(seq 768) | dd of="$IMG" bs=1 seek=$((0xBB00)) conv=notrunc 2>/dev/null
+tail -c +129 "$CPC" | dd of="$IMG" bs=1 seek="$LOAD" conv=notrunc 2>/dev/null
+
+if [ -n "$PROF" ]; then
+    $TICKS -trace -pc "$ENTRY" -end $((0x$ENDADDR)) "$IMG" |
+        python3 "$(dirname "$0")/profile.py" $PROFOPTS "$MAP" "$IMG"
+    exit
+fi
+
+OUT=$($TICKS -pc "$ENTRY" -end $((0x$ENDADDR)) "$IMG")
+echo "$OUT"
+if [ -n "$KEYS" ] && [ "$KEYS" -gt 0 ]; then
+    T=$(echo "$OUT" | grep -o '[0-9][0-9]*' | tail -1)
+    echo "$KEYS keys: $((T / KEYS)) T-states per key"
+fi